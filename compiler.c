@@ -5,17 +5,88 @@
 #include <string.h>
 #include <ctype.h>
 #include <strings.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/uio.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__)
+#include <immintrin.h>
+#define LEX_SIMD
+#endif
+
+
+
+// Arenas - bump allocators for data which is released all at once
+
+#define ARENA_BLOCK (64 * 1024)
+
+typedef struct ArenaBlock {
+	struct ArenaBlock *next;
+	size_t size, used;
+	_Alignas(max_align_t) char data[];
+} ArenaBlock;
+
+typedef struct {
+	ArenaBlock *head; // Block currently allocated from, older blocks follow
+} Arena;
+
+void *arena_alloc(Arena *a, size_t size) {
+	size = (size + _Alignof(max_align_t) - 1) & ~(_Alignof(max_align_t) - 1);
+
+	if (a->head == NULL || a->head->size - a->head->used < size) {
+		size_t block = size > ARENA_BLOCK ? size : ARENA_BLOCK;
+		ArenaBlock *add = malloc(sizeof(ArenaBlock) + block);
+		add->next = a->head;
+		add->size = block;
+		add->used = 0;
+		a->head = add;
+	}
+
+	void *out = a->head->data + a->head->used;
+	a->head->used += size;
+	return out;
+}
+
+char *arena_strdup(Arena *a, const char *str) {
+	size_t len = strlen(str) + 1;
+	return memcpy(arena_alloc(a, len), str, len);
+}
+
+// Releases everything allocated from the arena, keeping one block to
+// allocate from again
+void arena_reset(Arena *a) {
+	if (a->head == NULL)
+		return;
+
+	while (a->head->next != NULL) {
+		ArenaBlock *next = a->head->next;
+		a->head->next = next->next;
+		free(next);
+	}
+	a->head->used = 0;
+}
+
+void arena_end(Arena *a) {
+	while (a->head != NULL) {
+		ArenaBlock *next = a->head->next;
+		free(a->head);
+		a->head = next;
+	}
+}
 
 
 
 // Vector utils
 
-#define VECT_MAX_GROW 100
 #define VECT_MIN_SIZE 4
 
+// Vectors always keep room for two more elements than they hold: one so
+// an element can be inserted before growing (the element may live in the
+// vector itself) and one for the terminator added by vect_as_string.
 typedef struct {
 	size_t _el_sz, count, size;
 	void *data;
+	Arena *arena; // Storage comes from this arena when set, not the heap
 } Vector;
 
 Vector vect_init(size_t item_size) {
@@ -29,17 +100,45 @@ Vector vect_init(size_t item_size) {
 	return out;
 }
 
-void _vect_grow(Vector *v) {
-	if (v->size / 2 > VECT_MAX_GROW) {
-		v->size += VECT_MAX_GROW;
+// Vector whose storage is taken from the arena (or the heap if NULL).
+// Growing leaves the old storage behind until the arena is reset.
+Vector vect_init_in(Arena *a, size_t item_size) {
+	if (a == NULL)
+		return vect_init(item_size);
+
+	Vector out = {0};
+
+	out._el_sz = item_size;
+	out.size = VECT_MIN_SIZE;
+	out.count = 0;
+	out.data = arena_alloc(a, out.size * out._el_sz);
+	out.arena = a;
+
+	return out;
+}
+
+// Makes room for n more elements without reallocating
+void vect_reserve(Vector *v, size_t n) {
+	size_t need = v->count + n + 2;
+	if (need <= v->size)
+		return;
+
+	size_t size = v->size < VECT_MIN_SIZE ? VECT_MIN_SIZE : v->size;
+	while (size < need)
+		size *= 2;
+
+	if (v->arena != NULL) {
+		void *moved = arena_alloc(v->arena, size * v->_el_sz);
+		memcpy(moved, v->data, v->count * v->_el_sz);
+		v->data = moved;
 	} else {
-		v->size += v->size / 2;
+		v->data = realloc(v->data, size * v->_el_sz);
 	}
-	v->data = realloc(v->data, v->size * v->_el_sz);
+	v->size = size;
 }
 
 void _vect_shrink(Vector *v) {
-	if (v->size / 2 > VECT_MIN_SIZE) {
+	if (v->arena == NULL && v->size / 2 > VECT_MIN_SIZE) {
 		v->size = v->size / 2;
 		v->data = realloc(v->data, v->size * v->_el_sz);
 	}
@@ -51,11 +150,7 @@ bool vect_remove(Vector *v, size_t index) {
 	}
 
 	char *remove = v->data + (index * v->_el_sz);
-	char *override = v->data + (index + 1) * v->_el_sz;
-
-	for(size_t i = 0; i < (v->count - index - 1) * v->_el_sz; i++) {
-		remove[i] = override[i];
-	}
+	memmove(remove, remove + v->_el_sz, (v->count - index - 1) * v->_el_sz);
 
 	v->count -= 1;
 
@@ -75,24 +170,12 @@ bool vect_insert(Vector *v, size_t index, void *el) {
 		return false;
 	}
 
-	char *new_spot = v->data + (v->count + 1) * v->_el_sz;
-	char *old_spot = v->data + v->count * v->_el_sz;
-
-	for (size_t i = 0; i < (v->count - index) * v->_el_sz; i++) {
-		*new_spot = *old_spot;
-		new_spot--;
-		old_spot--;
-	}
-
-	for (size_t i = 0; i < v->_el_sz; i++) {
-		old_spot[i] = ((char *)el)[i];
-	}
+	char *spot = v->data + index * v->_el_sz;
+	memmove(spot + v->_el_sz, spot, (v->count - index) * v->_el_sz);
+	memcpy(spot, el, v->_el_sz);
 
 	v->count += 1;
-
-	if (v->count == v->size - 1) {
-		_vect_grow(v);
-	}
+	vect_reserve(v, 0);
 
 	return true;
 }
@@ -101,17 +184,45 @@ void vect_push(Vector *v, void *el) {
 	vect_insert(v, v->count, el);
 }
 
+// Pushes n elements at once, els must not point into the vector
+void vect_push_n(Vector *v, void *els, size_t n) {
+	if (n == 0)
+		return;
+
+	vect_reserve(v, n);
+	memcpy(v->data + v->count * v->_el_sz, els, n * v->_el_sz);
+	v->count += n;
+}
+
 void vect_push_string(Vector *v, char *str) {
 	if (v->_el_sz != sizeof(char)) {
 		return;
 	}
 
-	for (size_t i = 0; str[i] != 0; i++) {
-		vect_insert(v, v->count, str + i);
+	vect_push_n(v, str, strlen(str));
+}
+
+// Pushes the first n characters of the string
+void vect_push_nstring(Vector *v, const char *str, size_t n) {
+	if (v->_el_sz != sizeof(char)) {
+		return;
 	}
+
+	vect_push_n(v, (char *)str, n);
 }
 
+// Pushes a heap allocated string and frees it.  An empty vector takes
+// the string's memory over instead of copying it.
 void vect_push_free_string(Vector *v, char *str) {
+	if (v->_el_sz == sizeof(char) && v->count == 0 && v->arena == NULL) {
+		size_t len = strlen(str);
+		free(v->data);
+		v->data = realloc(str, len + 2);
+		v->count = len;
+		v->size = len + 2;
+		return;
+	}
+
 	vect_push_string(v, str);
 	free(str);
 }
@@ -128,29 +239,24 @@ Vector vect_clone(Vector *v) {
 	Vector out = {0};
 	
 	out._el_sz = v->_el_sz;
-	out.count = 0;
-	out.size = v->count + 1;
-
-	out.data = malloc((out.count + 1) * out._el_sz);
-
-	char *former = v->data;
-	char *latter = out.data;
+	out.count = v->count;
+	out.size = v->count + 2;
 
-	for(size_t i = 0; i < out.count * out._el_sz; i++) {
-		latter[i] = former[i];
-	}
+	out.data = malloc(out.size * out._el_sz);
+	memcpy(out.data, v->data, out.count * out._el_sz);
 
 	return out;
 }
 
 Vector vect_from_string(char *s) {
 	Vector out = vect_init(1);
+	vect_push_string(&out, s);
+	return out;
+}
 
-	size_t i = 0;
-	while(s[i] != 0) {
-		vect_push(&out, s + i++);
-	}
-
+Vector vect_from_nstring(const char *s, size_t n) {
+	Vector out = vect_init(1);
+	vect_push_nstring(&out, s, n);
 	return out;
 }
 
@@ -169,206 +275,648 @@ void vect_end(Vector *v) {
 	v->_el_sz = 0;
 	v->count = 0;
 	v->size = 0;
-	free(v->data);
+	if (v->arena == NULL)
+		free(v->data);
 	v->data = NULL;
+	v->arena = NULL;
+}
+
+
+
+// Symbols (interned strings)
+
+// Every name used by the compiler is interned once in a global pool and
+// referred to by its id, so two names are equal exactly when their ids are.
+// Id zero is never handed out and means "no name".
+
+// Symbols seeded into the pool ahead of time, in order.  The inbuilt
+// types must stay in the same order as TYP_INBUILT.
+#define SYM_NONE 0
+#define SYM_UINT8 1
+#define SYM_UINT16 2
+#define SYM_UINT32 3
+#define SYM_UINT64 4
+#define SYM_UINT 5
+#define SYM_INT8 6
+#define SYM_INT16 7
+#define SYM_INT32 8
+#define SYM_INT64 9
+#define SYM_INT 10
+#define SYM_FLOAT32 11
+#define SYM_FLOAT64 12
+#define SYM_FLOAT 13
+#define SYM_BOOL 14
+#define SYM_VOID 15
+#define SYM_TMP 16
+#define SYM_LITERAL 17
+
+char *SYM_SEED[] = {
+	"uint8", "uint16", "uint32", "uint64", "uint",
+	"int8", "int16", "int32", "int64", "int",
+	"float32", "float64", "float", "bool", "void",
+	"#tmp", "#literal"
+};
+
+Vector sym_strs = {0};      // Symbol id -> string
+int *sym_table = NULL;      // Open addressed table of symbol ids, zero when empty
+size_t sym_table_size = 0;  // Always a power of two
+
+size_t _sym_hash(const char *str, size_t len) {
+	size_t out = 14695981039346656037UL;
+	for (size_t i = 0; i < len; i++) {
+		out ^= (unsigned char)str[i];
+		out *= 1099511628211UL;
+	}
+	return out;
+}
+
+// Finds the slot in the table which holds (or would hold) the string
+size_t _sym_slot(const char *str, size_t len) {
+	size_t mask = sym_table_size - 1;
+	size_t i = _sym_hash(str, len) & mask;
+
+	while (sym_table[i] != 0) {
+		char **chk = vect_get(&sym_strs, sym_table[i]);
+		if (strncmp(*chk, str, len) == 0 && (*chk)[len] == 0)
+			break;
+		i = (i + 1) & mask;
+	}
+
+	return i;
+}
+
+void _sym_table_grow() {
+	int *old = sym_table;
+	size_t old_size = sym_table_size;
+
+	sym_table_size = old_size > 0 ? old_size * 2 : 256;
+	sym_table = calloc(sym_table_size, sizeof(int));
+
+	for (size_t i = 0; i < old_size; i++) {
+		if (old[i] == 0)
+			continue;
+		char **str = vect_get(&sym_strs, old[i]);
+		sym_table[_sym_slot(*str, strlen(*str))] = old[i];
+	}
+
+	free(old);
+}
+
+int sym_intern_n(const char *str, size_t len);
+
+void _sym_init() {
+	char *none = NULL;
+	sym_strs = vect_init(sizeof(char *));
+	vect_push(&sym_strs, &none);
+	_sym_table_grow();
+
+	for (size_t i = 0; i < sizeof(SYM_SEED)/sizeof(char *); i++) {
+		sym_intern_n(SYM_SEED[i], strlen(SYM_SEED[i]));
+	}
+}
+
+// Returns the symbol for the first len characters of the string,
+// adding it to the pool if it is new
+int sym_intern_n(const char *str, size_t len) {
+	if (sym_table == NULL)
+		_sym_init();
+
+	size_t slot = _sym_slot(str, len);
+	if (sym_table[slot] != 0)
+		return sym_table[slot];
+
+	char *copy = malloc(len + 1);
+	memcpy(copy, str, len);
+	copy[len] = 0;
+	vect_push(&sym_strs, &copy);
+
+	int out = sym_strs.count - 1;
+	sym_table[slot] = out;
+
+	if (sym_strs.count * 2 > sym_table_size)
+		_sym_table_grow();
+
+	return out;
+}
+
+int sym_intern(const char *str) {
+	return sym_intern_n(str, strlen(str));
+}
+
+// Takes ownership of the string, interns it, then frees it
+int sym_intern_free(char *str) {
+	int out = sym_intern(str);
+	free(str);
+	return out;
+}
+
+// Returns the symbol for the string if it has been interned, zero otherwise.
+// Names which were never interned can not match anything.
+int sym_find(const char *str) {
+	if (sym_table == NULL)
+		_sym_init();
+	return sym_table[_sym_slot(str, strlen(str))];
+}
+
+// String for the symbol, NULL for SYM_NONE.
+// Do NOT free this pointer, it lives as long as the pool.
+char *sym_str(int sym) {
+	if (sym_table == NULL)
+		_sym_init();
+
+	char **out = vect_get(&sym_strs, sym);
+	if (sym <= 0 || out == NULL)
+		return NULL;
+	return *out;
+}
+
+// Frees every symbol in the pool
+void sym_end() {
+	for (size_t i = 1; i < sym_strs.count; i++) {
+		char **str = vect_get(&sym_strs, i);
+		free(*str);
+	}
+	vect_end(&sym_strs);
+	free(sym_table);
+	sym_table = NULL;
+	sym_table_size = 0;
 }
 
 
 
-// Artifacts (vect of strings)
+// Artifacts (list of interned name segments)
+
+typedef struct {
+	Vector segs; // Segment symbols
+	int joined;  // Cached result of art_join, SYM_NONE until joined
+	char join;   // Character the cached join was made with
+} Artifact;
+
+// Artifact whose segments are stored in the arena (or the heap if NULL)
+Artifact art_init_in(Arena *a) {
+	Artifact out = {0};
+	out.segs = vect_init_in(a, sizeof(int));
+	out.joined = SYM_NONE;
+	return out;
+}
 
-typedef Vector Artifact;
+Artifact art_init() {
+	return art_init_in(NULL);
+}
 
 /* Splits the string via the given character, and
  * stores the split strings in an artifact
  */
 Artifact art_from_str(const char *str, char split) {
-	Artifact out = vect_init(sizeof(char *));
-
-	char *cur = malloc(1);
-	cur[0] = 0;
-	int cur_len = 0;
-
-	for (int i = 0; str[i] != 0; i++) {
-		if (str[i] == split) {
-			cur[cur_len] = 0;
-			vect_push(&out, &cur);
-			cur = malloc(1);
-			cur_len = 0;
-		} else {
-			cur_len += 1;
-			cur = realloc(cur, cur_len + 1);
-			cur[cur_len - 1] = str[i];
+	Artifact out = art_init();
+
+	const char *start = str;
+	for (; *str != 0; str++) {
+		if (*str == split) {
+			int seg = sym_intern_n(start, str - start);
+			vect_push(&out.segs, &seg);
+			start = str + 1;
 		}
 	}
 
-	if (cur_len > 0) {
-		cur[cur_len] = 0;
-		vect_push(&out, &cur);
-	} else {
-		free(cur);
+	// Trailing empty segments are dropped
+	if (str > start) {
+		int seg = sym_intern_n(start, str - start);
+		vect_push(&out.segs, &seg);
 	}
 
 	return out;
 }
 
-// Joins the string together with the provided character in between
-// must free the returned data after use.
+// Symbol for the segment at index, SYM_NONE if out of range
+int art_get(Artifact *art, size_t index) {
+	int *seg = vect_get(&art->segs, index);
+	if (seg == NULL)
+		return SYM_NONE;
+	return *seg;
+}
 
-char *art_to_str(Artifact *art, char join) {
-	char *out = malloc(1);
-	int out_len = 0;
+// Joins the segments together with the provided character in between,
+// returning the joined symbol.  The join is cached until the artifact
+// changes.
+int art_join(Artifact *art, char join) {
+	if (art->joined != SYM_NONE && art->join == join)
+		return art->joined;
 
-	for (size_t i = 0; i < art->count; i++) {
-		char ** cpy = vect_get(art, i);
-		
-		for(int j = 0; (*cpy)[j] != 0; j++) {
-			out[out_len] = (*cpy)[j];
-			out_len += 1;
-			out = realloc(out, out_len + 1);
-		}
-		
-		if (i < art->count - 1) {
-			out[out_len] = join;
-			out_len += 1;
-			out = realloc(out, out_len + 1);
-		}
+	Vector out = vect_init(sizeof(char));
+	for (size_t i = 0; i < art->segs.count; i++) {
+		if (i > 0)
+			vect_push(&out, &join);
+		vect_push_string(&out, sym_str(art_get(art, i)));
 	}
 
-	out[out_len] = 0;
+	art->joined = sym_intern_free(vect_as_string(&out));
+	art->join = join;
+	return art->joined;
+}
 
-	return out;
+// String form of art_join.  Do NOT free, it belongs to the symbol pool.
+char *art_to_str(Artifact *art, char join) {
+	return sym_str(art_join(art, join));
 }
 
-// Pops a string off the end of the artifact,
-// freeing the data associated
+// Pops a segment off the end of the artifact
 void art_pop_str(Artifact *art) {
-	if (art->count == 0)
+	if (art->segs.count == 0)
 		return;
 	
-	char ** to_free = vect_get(art, art->count - 1);
-	free(*to_free);
-	vect_pop(art);
+	vect_pop(&art->segs);
+	art->joined = SYM_NONE;
+}
+
+void art_add_sym(Artifact *art, int sym) {
+	vect_push(&art->segs, &sym);
+	art->joined = SYM_NONE;
 }
 
-// Copies a string onto the artifact,
-// you must free the original string
-// manually if it was malloc-ed
+// Adds a segment onto the artifact, the string is not kept
 void art_add_str(Artifact *art, char *str) {
-	Vector copy = vect_from_string(str);
-	char * copy_ptr = vect_as_string(&copy);
-	vect_push(art, &copy_ptr);
+	art_add_sym(art, sym_intern(str));
 }
 
 // a = a + b
 void art_add_art(Artifact *a, Artifact *b) {
-	for(size_t i = 0; i < b->count; i++) {
-		art_add_str(a, *(char **)vect_get(b, i));
+	for(size_t i = 0; i < b->segs.count; i++) {
+		art_add_sym(a, art_get(b, i));
 	}
 }
 
-// Weather the string str is contained in the artifact
-bool art_contains(Artifact *a, char *str) {
-	for (size_t i = 0; i < a->count; i++) {
-		char **cur = vect_get(a, i);
-		if (strcmp(str, *cur) == 0)
+// Weather the symbol is one of the artifact's segments
+bool art_contains(Artifact *a, int sym) {
+	for (size_t i = 0; i < a->segs.count; i++) {
+		if (art_get(a, i) == sym)
 			return true;
 	}
 	return false;
 }
 
-// Frees all strings in the artifact,
-// then calls vect_end
 void art_end(Artifact *art) {
-	char **to_free = art->data;
-	for(size_t i = 0; i < art->count; i++) {
-		free(to_free[i]);
+	vect_end(&art->segs);
+	art->joined = SYM_NONE;
+}
+
+
+// Symbol maps - open addressing hash tables from symbols to indices
+// (usually of the element with that name in some vector).
+
+typedef struct {
+	int sym;   // SYM_NONE for an empty slot
+	int index;
+} SymSlot;
+
+typedef struct {
+	SymSlot *slots;
+	size_t size;  // Slot count, always a power of two (zero before first put)
+	size_t count;
+	Arena *arena; // Slots come from this arena when set, not the heap
+} SymMap;
+
+SymMap smap_init(Arena *a) {
+	SymMap out = {0};
+	out.arena = a;
+	return out;
+}
+
+SymSlot *_smap_slot(SymSlot *slots, size_t size, int sym) {
+	size_t i = ((size_t)sym * 2654435761u) & (size - 1);
+	while (slots[i].sym != SYM_NONE && slots[i].sym != sym)
+		i = (i + 1) & (size - 1);
+	return slots + i;
+}
+
+void _smap_grow(SymMap *m) {
+	size_t size = m->size > 0 ? m->size * 2 : 16;
+	SymSlot *slots;
+	if (m->arena != NULL)
+		slots = arena_alloc(m->arena, size * sizeof(SymSlot));
+	else
+		slots = malloc(size * sizeof(SymSlot));
+	memset(slots, 0, size * sizeof(SymSlot));
+
+	for (size_t i = 0; i < m->size; i++) {
+		if (m->slots[i].sym != SYM_NONE)
+			*_smap_slot(slots, size, m->slots[i].sym) = m->slots[i];
+	}
+
+	if (m->arena == NULL)
+		free(m->slots);
+	m->slots = slots;
+	m->size = size;
+}
+
+// Maps sym to index.  If sym is already in the map the first index is kept.
+void smap_put(SymMap *m, int sym, int index) {
+	if (sym == SYM_NONE)
+		return;
+
+	if ((m->count + 1) * 4 > m->size * 3)
+		_smap_grow(m);
+
+	SymSlot *slot = _smap_slot(m->slots, m->size, sym);
+	if (slot->sym != SYM_NONE)
+		return;
+
+	slot->sym = sym;
+	slot->index = index;
+	m->count++;
+}
+
+// Index stored for sym, -1 if it is not in the map
+int smap_get(SymMap *m, int sym) {
+	if (m->size == 0 || sym == SYM_NONE)
+		return -1;
+
+	SymSlot *slot = _smap_slot(m->slots, m->size, sym);
+	if (slot->sym == SYM_NONE)
+		return -1;
+	return slot->index;
+}
+
+// Empties the map, keeping its slots for reuse
+void smap_clear(SymMap *m) {
+	if (m->size > 0)
+		memset(m->slots, 0, m->size * sizeof(SymSlot));
+	m->count = 0;
+}
+
+void smap_end(SymMap *m) {
+	if (m->arena == NULL)
+		free(m->slots);
+	m->slots = NULL;
+	m->size = 0;
+	m->count = 0;
+}
+
+
+// Ropes - text kept as a list of fixed size chunks.  Appending never
+// moves text already written and two ropes are joined without copying.
+
+#define ROPE_CHUNK 4096
+
+typedef struct RopeChunk {
+	struct RopeChunk *next;
+	size_t len;
+	char data[ROPE_CHUNK];
+} RopeChunk;
+
+typedef struct {
+	RopeChunk *first, *last;
+	size_t len;
+} Rope;
+
+Rope rope_init() {
+	Rope out = {0};
+	return out;
+}
+
+// Pushes the first n characters of the string
+void rope_push_nstring(Rope *r, const char *str, size_t n) {
+	r->len += n;
+	while (n > 0) {
+		if (r->last == NULL || r->last->len == ROPE_CHUNK) {
+			RopeChunk *add = malloc(sizeof(RopeChunk));
+			add->next = NULL;
+			add->len = 0;
+			if (r->last == NULL)
+				r->first = add;
+			else
+				r->last->next = add;
+			r->last = add;
+		}
+
+		size_t fit = ROPE_CHUNK - r->last->len;
+		if (fit > n)
+			fit = n;
+		memcpy(r->last->data + r->last->len, str, fit);
+		r->last->len += fit;
+		str += fit;
+		n -= fit;
+	}
+}
+
+void rope_push_string(Rope *r, const char *str) {
+	rope_push_nstring(r, str, strlen(str));
+}
+
+void rope_push_free_string(Rope *r, char *str) {
+	rope_push_string(r, str);
+	free(str);
+}
+
+// Moves all of b's text onto the end of a, leaving b empty
+void rope_join(Rope *a, Rope *b) {
+	if (b->first == NULL)
+		return;
+
+	if (a->last == NULL)
+		a->first = b->first;
+	else
+		a->last->next = b->first;
+	a->last = b->last;
+	a->len += b->len;
+
+	*b = rope_init();
+}
+
+void rope_end(Rope *r) {
+	while (r->first != NULL) {
+		RopeChunk *next = r->first->next;
+		free(r->first);
+		r->first = next;
 	}
-	vect_end(art);
+	*r = rope_init();
 }
 
 
+
 // Compile Data - CompData holds final program as it is assembled
 typedef struct {
-	Vector header, data, text;
+	Rope header, data, text;
+	FILE *text_seg; // When streaming, finished text is moved here (not owned)
 } CompData;
 
 CompData cdat_init() {
 	CompData out = {0};
 
-	out.header = vect_from_string("");
-	out.data = vect_from_string("");
-	out.text = vect_from_string("");
+	out.header = rope_init();
+	out.data = rope_init();
+	out.text = rope_init();
+
+	return out;
+}
 
+// Compile data which streams its finished text out to the given file
+// (see cdat_flush) rather than keeping all of it in memory
+CompData cdat_init_stream(FILE *text_seg) {
+	CompData out = cdat_init();
+	out.text_seg = text_seg;
 	return out;
 }
 
+// Moves the text assembled so far out to the text segment, if streaming
+void cdat_flush(CompData *cdat) {
+	if (cdat->text_seg == NULL)
+		return;
+
+	for (RopeChunk *c = cdat->text.first; c != NULL; c = c->next)
+		fwrite(c->data, sizeof(char), c->len, cdat->text_seg);
+	rope_end(&cdat->text);
+}
+
+// Moves all of b's output onto the end of a's
 void cdat_add(CompData *a, CompData *b) {
-	vect_push_string(&a->header, vect_as_string(&b->header));
-	vect_push_string(&a->data, vect_as_string(&b->data));
-	vect_push_string(&a->text, vect_as_string(&b->text));
+	rope_join(&a->header, &b->header);
+	rope_join(&a->data, &b->data);
+	rope_join(&a->text, &b->text);
+}
+
+#define CDAT_IOV_MAX 64
+
+// Writes everything in the list, picking up after short writes
+bool _cdat_writev(int fd, struct iovec *iov, int count) {
+	while (count > 0) {
+		ssize_t wrote = writev(fd, iov, count);
+		if (wrote < 0) {
+			if (errno == EINTR)
+				continue;
+			return false;
+		}
+
+		while (count > 0 && (size_t)wrote >= iov->iov_len) {
+			wrote -= iov->iov_len;
+			iov++;
+			count--;
+		}
+
+		if (count > 0) {
+			iov->iov_base = (char *)iov->iov_base + wrote;
+			iov->iov_len -= wrote;
+		}
+	}
+	return true;
+}
+
+// Adds every chunk of the rope to the write list, writing the list out
+// whenever it fills.  Returns false if a write fails.
+bool _cdat_write_rope(int fd, struct iovec *iov, int *count, Rope *r) {
+	for (RopeChunk *c = r->first; c != NULL; c = c->next) {
+		if (*count == CDAT_IOV_MAX) {
+			if (!_cdat_writev(fd, iov, *count))
+				return false;
+			*count = 0;
+		}
+		iov[*count].iov_base = c->data;
+		iov[*count].iov_len = c->len;
+		*count += 1;
+	}
+	return true;
+}
+
+// Copies the streamed text segment to the file.  Returns false if
+// either side fails.
+bool _cdat_copy_seg(int fd, FILE *seg) {
+	char buf[1 << 16];
+	size_t got;
+
+	// Failed writes to the segment (see cdat_flush) are caught here,
+	// before rewind clears the error
+	if (fflush(seg) != 0 || ferror(seg))
+		return false;
+	rewind(seg);
+	while ((got = fread(buf, sizeof(char), sizeof(buf), seg)) > 0) {
+		struct iovec iov = {buf, got};
+		if (!_cdat_writev(fd, &iov, 1))
+			return false;
+	}
+	return ferror(seg) == 0;
 }
 
-void cdat_write_to_file(CompData *cdat, FILE *fout) {
-	fprintf(fout, "bits 64\n");
-	fprintf(fout, "\n%s\n", vect_as_string(&(cdat->header)));
-	fprintf(fout, "section .data\n%s\n", vect_as_string(&(cdat->data)));
-	fprintf(fout, "section .text\n%s\n", vect_as_string(&(cdat->text)));
+// Writes the finished program out.  Returns false if the write fails.
+bool cdat_write_to_file(CompData *cdat, FILE *fout) {
+	char *parts[] = {"bits 64\n\n", "\nsection .data\n", "\nsection .text\n", "\n"};
+	Rope *sections[] = {&cdat->header, &cdat->data, &cdat->text};
+
+	struct iovec iov[CDAT_IOV_MAX];
+	int count = 0;
+	int fd = fileno(fout);
 	fflush(fout);
+	cdat_flush(cdat);
+
+	for (int i = 0; i < 4; i++) {
+		if (count == CDAT_IOV_MAX) {
+			if (!_cdat_writev(fd, iov, count))
+				return false;
+			count = 0;
+		}
+		iov[count].iov_base = parts[i];
+		iov[count].iov_len = strlen(parts[i]);
+		count++;
+
+		if (i < 3 && !_cdat_write_rope(fd, iov, &count, sections[i]))
+			return false;
+
+		// Streamed text goes after everything else in the text section
+		if (i == 2 && cdat->text_seg != NULL) {
+			if (!_cdat_writev(fd, iov, count) || !_cdat_copy_seg(fd, cdat->text_seg))
+				return false;
+			count = 0;
+		}
+	}
+
+	return _cdat_writev(fd, iov, count);
 }
 
 void cdat_end(CompData *cdat) {
-	vect_end(&(cdat->header));
-	vect_end(&(cdat->data));
-	vect_end(&(cdat->text));
+	rope_end(&(cdat->header));
+	rope_end(&(cdat->data));
+	rope_end(&(cdat->text));
 }
 
 
 
 // Gen utils
 
-char *int_to_str(int i) {
-	Vector v = vect_init(sizeof(char));
-	
-	char to_push = '0';
-	bool minus = false;
+// Most characters an int can take up in decimal
+#define INT_STR_MAX 12
 
-	// check negative
-	if(i < 0) {
-		i = -i;
-		minus = true;
-	}
+// Writes i in decimal to buf (which must fit INT_STR_MAX characters)
+// and returns the length.  Does not null terminate.
+int _fmt_int(char *buf, int i) {
+	char tmp[INT_STR_MAX];
+	long l = i;
+	int len = 0;
 
-	// zero case
-	if(i == 0) {
-		vect_push(&v, &to_push);
-	}
+	if (l < 0)
+		l = -l;
 
 	// get all digits (in reverse order)
-	while(i > 0) {
-		to_push = '0' + i % 10;
-		i = i / 10;
-		vect_push(&v, &to_push);
-	}
+	do {
+		tmp[len++] = '0' + l % 10;
+		l = l / 10;
+	} while (l > 0);
 
-	// handle negative
-	if(minus) {
-		to_push = '-';
-		vect_push(&v, &to_push);
-	}
+	if (i < 0)
+		tmp[len++] = '-';
 
-	// reverse string
-	for(size_t idx = 0; idx < v.count / 2; idx++) {
-		to_push = *(char*)vect_get(&v, idx);
-		((char*)v.data)[idx] = ((char*)v.data)[v.count - (idx + 1)];
-		((char*)v.data)[v.count - (idx + 1)] = to_push;
-	}
+	for (int idx = 0; idx < len; idx++)
+		buf[idx] = tmp[len - (idx + 1)];
+
+	return len;
+}
 
-	//push 0
-	to_push = 0;
-	vect_push(&v, &to_push);
+void vect_push_int(Vector *v, int i) {
+	char buf[INT_STR_MAX];
+	vect_push_nstring(v, buf, _fmt_int(buf, i));
+}
 
-	return v.data;
+void rope_push_int(Rope *r, int i) {
+	char buf[INT_STR_MAX];
+	rope_push_nstring(r, buf, _fmt_int(buf, i));
 }
 
 
@@ -376,23 +924,43 @@ char *int_to_str(int i) {
 // Types
 
 typedef struct Module {
-	char *name;
+	int name;
 	bool exported;
 	Vector types, vars, funcs, submods;
+	// Name -> index of the first element with that name, kept in sync by
+	// the mod_add_ functions.  sub_lookup also indexes enum ("@@") and
+	// method ("_#") submodules under their base name.
+	SymMap type_map, var_map, func_map, sub_map, sub_lookup;
+	SymMap memo[3]; // Phase 2 lookup results by kind (see _mod_find_memo)
+	char *label;    // Cached label prefix (see mod_label_prefix), NULL until used
 	struct Module *parent;
 } Module;
 
 typedef struct {
-	char *name;         // Name of the type
+	int name;           // Name of the type (symbol)
 	int size;           // Size (bytes) of the type
 	Vector members;     // Member variables (Stored as variables)
 	Module *module;     // Module (for methods and member-type resolution) to tie the type to.
 } Type;
 
+// Pointer chains are almost always a few entries long, so they are kept
+// inline and only spill out into separate storage when they grow past
+// PTR_CHAIN_INLINE.  Copy with ptrc_copy, as a spilled chain is not
+// shared between copies.
+#define PTR_CHAIN_INLINE 8
+
 typedef struct {
-	char *name;
+	size_t count;
+	size_t size;  // Capacity of spill
+	int *spill;   // Storage once the chain outgrows inl (NULL before)
+	Arena *arena; // Spill storage comes from this arena when set, not the heap
+	int inl[PTR_CHAIN_INLINE];
+} PtrChain;
+
+typedef struct {
+	int name;     // Symbol
 	Type *type;
-	Vector ptr_chain;
+	PtrChain ptr_chain;
 	int location; // negative one for on stack, negative two for literal, zero for in data section, positive for in register
 	int offset;   // offset for member variables (if this is a literal, it represents the actual value)
 	Module *mod;  // Only used in the case of a data section variable;
@@ -408,30 +976,51 @@ typedef struct {
 #define PTYPE_ARR 1
 
 typedef struct {
-	char *name;
+	int name;     // Symbol
 	Vector inputs, outputs;
 	Module *module;
 } Function;
 
+// Name lookup for one of a scope's variable lists.  Removing a variable
+// shifts the ones after it, so the map is rebuilt on the next lookup if
+// an indexed variable could have moved.  Tmp variables are not indexed.
+typedef struct {
+	SymMap map;   // Name -> index of the first variable with that name
+	int top;      // Highest index in the map (-1 for none)
+	bool stale;
+} VarIndex;
+
 typedef struct Scope {
 	char *name;
+	char *label;  // Full label (module prefix, parent scopes and name)
 	Module *current;
 	Vector stack_vars, reg_vars;
+	VarIndex stack_index, reg_index;
+	int reg_used;    // Registers held by this scope's variables (RMSK_*)
+	int reg_base;    // Registers held by the parent scopes
+	int stack_top;   // Lowest stack offset used by this scope or its parents
+	int stack_base;  // Lowest stack offset used by the parent scopes
 	struct Scope *parent;
 	int next_const;
 	int next_bool;
 } Scope;
 
 
-// Copies the name, does not copy the module.
-// Types should be freed at the end of the second pass,
-// as they are shared among all variable structs
-Type typ_init(char *name, Module *module) {
+// The module tree built in phase 1 lives in mod_arena for the whole
+// compile.  Variables and scopes made while compiling a function live in
+// p2_scratch, which is reset once the function is done (see compile).
+Arena mod_arena = {0};
+Arena p2_scratch = {0};
+Arena *var_arena = NULL; // Where new variables are stored (NULL for the heap)
+
+// Does not copy the module.
+// Types are freed with the rest of the module tree at the end of the
+// second pass, as they are shared among all variable structs
+Type typ_init(int name, Module *module) {
 	Type out = {0};
 
-	Vector name_cpy = vect_from_string(name);
-	out.name = vect_as_string(&name_cpy);
-	out.members = vect_init(sizeof(Variable));
+	out.name = name;
+	out.members = vect_init_in(&mod_arena, sizeof(Variable));
 	out.module = module;
 	out.size = 0;
 
@@ -441,9 +1030,8 @@ Type typ_init(char *name, Module *module) {
 void var_end(Variable *v);
 
 // Deep end, will free all memory associated with the
-// struct, including name and sub-member variables
+// struct, including sub-member variables
 void typ_end(Type *t) {
-	free(t->name);
 	t->module = NULL;
 
 	for (size_t i = 0; i < t->members.count; i++) {
@@ -454,148 +1042,205 @@ void typ_end(Type *t) {
 	vect_end(&(t->members));
 }
 
+// Indexed by symbol, see SYM_UINT8 through SYM_VOID
 Type TYP_INBUILT[] = {
-	{"uint8", 1, {0}, NULL},
-	{"uint16", 2, {0}, NULL},
-	{"uint32", 4, {0}, NULL},
-	{"uint64", 8, {0}, NULL},
-	{"uint", 8, {0}, NULL},      // Platform max uint
-	{"int8", 1, {0}, NULL},
-	{"int16", 2, {0}, NULL},
-	{"int32", 4, {0}, NULL},
-	{"int64", 8, {0}, NULL},
-	{"int", 8, {0}, NULL},       // Platform max int
-	{"float32", 4, {0}, NULL},
-	{"float64", 8, {0}, NULL},
-	{"float", 8, {0}, NULL},     // Platform max float
-	{"bool", 1, {0}, NULL},
-	{"void", 8, {0}, NULL},      // Untyped pointer
+	{SYM_UINT8, 1, {0}, NULL},
+	{SYM_UINT16, 2, {0}, NULL},
+	{SYM_UINT32, 4, {0}, NULL},
+	{SYM_UINT64, 8, {0}, NULL},
+	{SYM_UINT, 8, {0}, NULL},      // Platform max uint
+	{SYM_INT8, 1, {0}, NULL},
+	{SYM_INT16, 2, {0}, NULL},
+	{SYM_INT32, 4, {0}, NULL},
+	{SYM_INT64, 8, {0}, NULL},
+	{SYM_INT, 8, {0}, NULL},       // Platform max int
+	{SYM_FLOAT32, 4, {0}, NULL},
+	{SYM_FLOAT64, 8, {0}, NULL},
+	{SYM_FLOAT, 8, {0}, NULL},     // Platform max float
+	{SYM_BOOL, 1, {0}, NULL},
+	{SYM_VOID, 8, {0}, NULL},      // Untyped pointer
 };
 
-Type *typ_get_inbuilt(char *name) {
-	for (size_t i = 0; i < sizeof(TYP_INBUILT)/sizeof(Type); i++) {
-		if (strcmp(TYP_INBUILT[i].name, name) == 0) {
-			return &(TYP_INBUILT[i]);
-		}
-	}
+bool is_inbuilt(int name) {
+	return name >= SYM_UINT8 && name <= SYM_VOID;
+}
+
+Type *typ_get_inbuilt(int name) {
+	if (is_inbuilt(name))
+		return &(TYP_INBUILT[name - SYM_UINT8]);
 	return NULL;
 }
 
-bool is_inbuilt(char *name) {
-	for (size_t i = 0; i < sizeof(TYP_INBUILT)/sizeof(Type); i++) {
-		if (strcmp(TYP_INBUILT[i].name, name) == 0) {
-			return true;
-		}
-	}
-	return false;
-}
-
 
 // SCOPE FUNCTIONS
 
+char *mod_label_prefix(Module *m);
+
+// Full label of the scope: the module's label prefix followed by the
+// names of every scope down to this one, separated by '#'.  Must be
+// called again if the parent changes.
+char *_scope_make_label(Scope *s) {
+	Vector out = vect_init_in(&p2_scratch, sizeof(char));
+
+	if (s->parent != NULL) {
+		vect_push_string(&out, s->parent->label);
+		vect_push_string(&out, "#");
+	} else {
+		vect_push_string(&out, mod_label_prefix(s->current));
+	}
+	vect_push_string(&out, s->name);
+
+	return vect_as_string(&out);
+}
+
 Scope scope_init(char *name, Module *mod) {
 	Scope out = {0};
 
-	Vector cpy = vect_from_string(name);
-	out.name = vect_as_string(&cpy);
+	out.name = arena_strdup(&p2_scratch, name);
 
-	out.stack_vars = vect_init(sizeof(Variable));
-	out.reg_vars = vect_init(sizeof(Variable));
+	out.stack_vars = vect_init_in(&p2_scratch, sizeof(Variable));
+	out.reg_vars = vect_init_in(&p2_scratch, sizeof(Variable));
+	out.stack_index.map = smap_init(&p2_scratch);
+	out.stack_index.top = -1;
+	out.reg_index.map = smap_init(&p2_scratch);
+	out.reg_index.top = -1;
+	out.stack_top = out.stack_base = -56;
 	out.current = mod;
 
 	out.next_const = 0;
 	out.next_bool = 0;
 
+	out.label = _scope_make_label(&out);
+
 	return out;
 }
 
+// Scopes and their variables are kept in p2_scratch, so there is nothing
+// to free here, it all goes when the function is done
 void scope_end(Scope *s) {
-	free(s->name);
-	
-	for(size_t i = 0; i < s->stack_vars.count; i++) {
-		Variable *v = vect_get(&s->stack_vars, i);
-		var_end(v);
-	}
+	s->name = NULL;
+	s->label = NULL;
 	vect_end(&s->stack_vars);
-
-	for(size_t i = 0; i < s->reg_vars.count; i++) {
-		Variable *v = vect_get(&s->reg_vars, i);
-		var_end(v);
-	}
 	vect_end(&s->reg_vars);
 }
 
-// Label generation
-void _scope_name_rec(Scope *s, Vector *v) {
-	// Base case
-	if (s == NULL)
-		return;
+// Label generation, written straight to the output
 
-	_scope_name_rec(s->parent, v);
-	
-	// Add # before name if not directly from module
-	if (s->parent != NULL)
-		vect_push_string(v, "#");
-	vect_push_string(v, s->name);
+void scope_label_start(Rope *r, Scope *s) {
+	rope_push_string(r, s->label);
+	rope_push_string(r, "#start");
 }
 
-char *mod_label_prefix(Module *m);
-Vector _scope_base_label(Scope *s) {
-	Vector out = vect_from_string("");
-	vect_push_free_string(&out, mod_label_prefix(s->current));
+void scope_label_rep(Rope *r, Scope *s) {
+	rope_push_string(r, s->label);
+	rope_push_string(r, "#rep");
+}
 
-	_scope_name_rec(s, &out);
+void scope_label_end(Rope *r, Scope *s) {
+	rope_push_string(r, s->label);
+	rope_push_string(r, "#end");
+}
 
-	return out;
+// Makes a new label for a constant in the data section
+int scope_gen_const_label(Scope *s) {
+	Vector out = vect_from_string(s->label);
+	vect_push_string(&out, "#const");
+	vect_push_int(&out, s->next_const);
+	s->next_const++;
+	return sym_intern_free(vect_as_string(&out));
 }
 
-char *scope_label_start(Scope *s) {
-	Vector out = _scope_base_label(s);
-	vect_push_string(&out, "#start");
-	return vect_as_string(&out);
+void scope_gen_bool_label(Rope *r, Scope *s) {
+	rope_push_string(r, s->label);
+	rope_push_string(r, "#bool");
+	rope_push_int(r, s->next_bool);
 }
 
-char *scope_label_rep(Scope *s) {
-	Vector out = _scope_base_label(s);
-	vect_push_string(&out, "#rep");
-	return vect_as_string(&out);
+void scope_adv_bool_label(Scope *s) {
+	s->next_bool++;
 }
 
-char *scope_label_end(Scope *s) {
-	Vector out = _scope_base_label(s);
-	vect_push_string(&out, "#end");
-	return vect_as_string(&out);
+// Pointer chains
+
+PtrChain ptrc_init(Arena *a) {
+	PtrChain out = {0};
+	out.arena = a;
+	return out;
 }
 
-char *scope_gen_const_label(Scope *s) {
-	Vector out = _scope_base_label(s);
-	vect_push_string(&out, "#const");
-	vect_push_free_string(&out, int_to_str(s->next_const));
-	s->next_const++;
-	return vect_as_string(&out);
+int *ptrc_get(PtrChain *c, size_t index) {
+	if (index >= c->count) {
+		return NULL;
+	}
+
+	if (c->spill != NULL)
+		return c->spill + index;
+	return c->inl + index;
 }
 
-char *scope_gen_bool_label(Scope *s) {
-	Vector out = _scope_base_label(s);
-	vect_push_string(&out, "#bool");
-	vect_push_free_string(&out, int_to_str(s->next_bool));
-	return vect_as_string(&out);
+void ptrc_push(PtrChain *c, int ptype) {
+	if (c->spill == NULL && c->count < PTR_CHAIN_INLINE) {
+		c->inl[c->count++] = ptype;
+		return;
+	}
+
+	if (c->spill == NULL || c->count == c->size) {
+		size_t size = c->size > 0 ? c->size * 2 : PTR_CHAIN_INLINE * 2;
+		int *old = c->spill != NULL ? c->spill : c->inl;
+		int *add;
+		if (c->arena != NULL)
+			add = arena_alloc(c->arena, size * sizeof(int));
+		else
+			add = malloc(size * sizeof(int));
+		memcpy(add, old, c->count * sizeof(int));
+
+		if (c->spill != NULL && c->arena == NULL)
+			free(c->spill);
+		c->spill = add;
+		c->size = size;
+	}
+
+	c->spill[c->count++] = ptype;
 }
 
-void scope_adv_bool_label(Scope *s) {
-	s->next_bool++;
+void ptrc_pop(PtrChain *c) {
+	if (c->count > 0)
+		c->count--;
+}
+
+// Struct assignment is a full copy unless the chain has spilled
+PtrChain ptrc_copy(PtrChain *c, Arena *a) {
+	PtrChain out = *c;
+	out.arena = a;
+	if (c->spill == NULL)
+		return out;
+
+	out.spill = NULL;
+	out.count = 0;
+	out.size = 0;
+	for (size_t i = 0; i < c->count; i++)
+		ptrc_push(&out, c->spill[i]);
+	return out;
+}
+
+void ptrc_end(PtrChain *c) {
+	if (c->spill != NULL && c->arena == NULL)
+		free(c->spill);
+	c->spill = NULL;
+	c->count = 0;
+	c->size = 0;
+	c->arena = NULL;
 }
 
 // Variables
 
-// Initializes the variable, copying name, not deep copying type as it is a pointer.
-Variable var_init(char *name, Type *type) {
+// Initializes the variable, not deep copying type as it is a pointer.
+Variable var_init(int name, Type *type) {
 	Variable out = {0};
 	
-	Vector name_cpy = vect_from_string(name);
-	out.name = vect_as_string(&name_cpy);
+	out.name = name;
 	out.type = type;
-	out.ptr_chain = vect_init(sizeof(int));
+	out.ptr_chain = ptrc_init(var_arena);
 	out.location = 0;
 	out.offset = 0;
 	out.mod = NULL;
@@ -604,24 +1249,14 @@ Variable var_init(char *name, Type *type) {
 }
 
 Variable var_copy(Variable *to_copy) {
-	Variable out = var_init(to_copy->name, to_copy->type);
-
-	out.location = to_copy->location;
-	out.offset = to_copy->offset;
-	out.mod = to_copy->mod;
-
-	for (size_t i = 0; i < to_copy->ptr_chain.count; i++) {
-		int *ptr_orig = vect_get(&(to_copy->ptr_chain), i);
-		vect_push(&(out.ptr_chain), ptr_orig);
-	}
-
+	Variable out = *to_copy;
+	out.ptr_chain = ptrc_copy(&(to_copy->ptr_chain), var_arena);
 	return out;
 }
 
 // Simple cleanup for variables while the second pass is ongoing.
 void var_end(Variable *v) {
-	free(v->name);
-	vect_end(&(v->ptr_chain));
+	ptrc_end(&(v->ptr_chain));
 }
 
 // Variable operations
@@ -638,46 +1273,89 @@ char *PREFIXES[] = {
 	"qword "
 };
 
-/// Remember to free!
-char *_gen_address(char *prefix, char *base, char *offset, int mult, int add, bool rel) {
-	Vector out = vect_init(sizeof(char));
+// Kinds of instruction operands
+#define OPND_IMM 0
+#define OPND_REG 1
+#define OPND_MEM 2
 
-	vect_push_string(&out, prefix);
-	if (rel)
-		vect_push_string(&out, "[rel ");
-	else
-		vect_push_string(&out, "[");
-	vect_push_string(&out, base);
-	
-	if (offset != NULL && mult > 0) {
-		vect_push_string(&out, " + ");
-		vect_push_string(&out, offset);
-		if(mult > 1) {
-			vect_push_string(&out, "*");
-			char *mstr = int_to_str(mult);
-			vect_push_string(&out, mstr);
-			free(mstr);
-		}
+// An instruction operand.  Operands only point at static strings and
+// variables, so they can be passed around by value and are written
+// straight to the output by _op_push without building a string first.
+typedef struct {
+	int kind;
+	char *prefix;    // Size prefix for memory operands
+	char *base;      // Register name, or base register of a memory operand
+	Variable *label; // Data section variable a memory operand is relative to
+	char *index;     // Index register of a memory operand (NULL for none)
+	int mult;
+	int add;         // Immediate value, or memory operand displacement
+} Operand;
+
+Operand _op_imm(int value) {
+	Operand out = {0};
+	out.kind = OPND_IMM;
+	out.add = value;
+	return out;
+}
+
+// [base + index*mult + add]
+Operand _op_mem(char *prefix, char *base, char *index, int mult, int add) {
+	Operand out = {0};
+	out.kind = OPND_MEM;
+	out.prefix = prefix;
+	out.base = base;
+	out.index = index;
+	out.mult = mult;
+	out.add = add;
+	return out;
+}
+
+// [rel label + add] where label is the variable's data section label
+Operand _op_data(char *prefix, Variable *var, int add) {
+	Operand out = _op_mem(prefix, NULL, NULL, 0, add);
+	out.label = var;
+	return out;
+}
+
+void _var_push_datalabel(Rope *r, Variable *var);
+
+void _op_push(Rope *r, Operand op) {
+	if (op.kind == OPND_IMM) {
+		rope_push_int(r, op.add);
+		return;
+	} else if (op.kind == OPND_REG) {
+		rope_push_string(r, op.base);
+		return;
 	}
 
-	if(add != 0) {
-		if (add > 0) {
-			vect_push_string(&out, " + ");
-		} else {
-			vect_push_string(&out, " - ");
-			add = -add;
+	rope_push_string(r, op.prefix);
+	if (op.label != NULL) {
+		rope_push_string(r, "[rel ");
+		_var_push_datalabel(r, op.label);
+	} else {
+		rope_push_string(r, "[");
+		rope_push_string(r, op.base);
+	}
+
+	if (op.index != NULL && op.mult > 0) {
+		rope_push_string(r, " + ");
+		rope_push_string(r, op.index);
+		if(op.mult > 1) {
+			rope_push_string(r, "*");
+			rope_push_int(r, op.mult);
 		}
-		char *astr = int_to_str(add);
-		vect_push_string(&out, astr);
-		free(astr);
 	}
 
-	
-	vect_push_string(&out, "]");
+	if(op.add > 0) {
+		rope_push_string(r, " + ");
+		rope_push_int(r, op.add);
+	} else if (op.add < 0) {
+		rope_push_string(r, " - ");
+		rope_push_int(r, -op.add);
+	}
 
-	return vect_as_string(&out);
+	rope_push_string(r, "]");
 }
-
 // Type coercion engine
 // TODO: all
 Variable _op_coerce(Variable *base, Variable *to_coerce) {
@@ -701,14 +1379,14 @@ int _var_ptr_type(Variable *v) {
 		// Return an invalid value if ptr_chain has no values.
 		return PTYPE_NONE;
 	}
-	return ((int*)v->ptr_chain.data)[v->ptr_chain.count - 1];
+	return *ptrc_get(&v->ptr_chain, v->ptr_chain.count - 1);
 }
 
 // Get the first non-reference value from ptr_chain
 int _var_first_nonref(Variable *v) {
 	int *chk;
 	for(size_t i = v->ptr_chain.count; i > 0; i--) {
-		chk = vect_get(&v->ptr_chain, i - 1);
+		chk = ptrc_get(&v->ptr_chain, i - 1);
 		if(*chk != PTYPE_REF) {
 			return *chk;
 		}
@@ -720,101 +1398,53 @@ int _var_first_nonref(Variable *v) {
 // rax (1), rdx (4), rsi (5), rdi (6).  Other registers assumed to be used by
 // variables
 // 1 - rax; 2 - rbx; 3 - rcx; 4 -  rdx; 5 - rsi; 6 - rdi; 7 - rsp; 8 - rbp; 9-16: r8-r15
-char *_op_get_register(int reg, int size) {
-	Vector out = vect_init(sizeof(char));
-	char add = 'r';
+char *REG_NAMES[][4] = {
+	{"al", "ax", "eax", "rax"},
+	{"bl", "bx", "ebx", "rbx"},
+	{"cl", "cx", "ecx", "rcx"},
+	{"dl", "dx", "edx", "rdx"},
+	{"sil", "si", "esi", "rsi"},
+	{"dil", "di", "edi", "rdi"},
+	{"spl", "sp", "esp", "rsp"},
+	{"bpl", "bp", "ebp", "rbp"},
+	{"r8b", "r8w", "r8d", "r8"},
+	{"r9b", "r9w", "r9d", "r9"},
+	{"r10b", "r10w", "r10d", "r10"},
+	{"r11b", "r11w", "r11d", "r11"},
+	{"r12b", "r12w", "r12d", "r12"},
+	{"r13b", "r13w", "r13d", "r13"},
+	{"r14b", "r14w", "r14d", "r14"},
+	{"r15b", "r15w", "r15d", "r15"}
+};
 
-	switch(size) {
-		case 1:
-		case 2:
-			if (reg < 9)
-				break;
-		case 4:
-			if (reg < 9)
-				add = 'e';
-		case 8:
-			vect_push(&out, &add);
-			break;
-		default:
-			printf("ERROR: invalid register size %d (this is a compiler issue)\n", size);
-			vect_push(&out, &add);
-			break;
+// Name of the register's lower size bytes
+char *_op_reg_name(int reg, int size) {
+	if (reg < 1 || reg > 16) {
+		printf("ERROR: invalid register %d (this is a compiler issue)\n", reg);
+		reg = 1;
 	}
 
-	switch(reg) {
+	switch(size) {
 		case 1:
+			return REG_NAMES[reg - 1][0];
 		case 2:
-		case 3:
+			return REG_NAMES[reg - 1][1];
 		case 4:
-			add = 'a' + (reg - 1);
-			break;
-		case 5:
-		case 7:
-			add = 's';
-			break;
-		case 6:
-			add = 'd';
-			break;
-		case 8:
-			add = 'b';
-			break;
-		default:
-
-			if(reg > 8) {
-				char *tmp = int_to_str(reg - 1);
-				vect_push_string(&out, tmp);
-				free(tmp);
-			}
-			add = 0;
-			break;
-	}
-
-	if (add > 0)
-		vect_push(&out, &add);
-
-	add = 'x';
-	switch (reg) {
-		// Cases rsi, rdi, rsp, rbp need extra character
-		case 5:
-		case 6:
-			add = 'i';
-		case 7:
+			return REG_NAMES[reg - 1][2];
 		case 8:
-			if (add == 'x') {
-				add = 'p';
-			}
-			if (size == 1) {
-				vect_push(&out, &add);
-			}
-		case 1:
-		case 2:
-		case 3:
-		case 4:
-			// Add l if lower 8 bits, just push x otherwise
-			if(size == 1) {
-				add = 'l';
-			}
-			vect_push(&out, &add);
-			break;
-		default:
-			// r8 - r15
-			if (size == 1) {
-				add = 'b';
-			} else if (size == 2) {
-				add = 'w';
-			} else if (size == 4) {
-				add = 'd';
-			}
-
-			if (size < 8) {
-				vect_push(&out, &add);
-			}
-			break;
+			return REG_NAMES[reg - 1][3];
 	}
 
-	return vect_as_string(&out);
+	printf("ERROR: invalid register size %d (this is a compiler issue)\n", size);
+	return REG_NAMES[reg - 1][3];
 }
 
+Operand _op_reg(int reg, int size) {
+	Operand out = {0};
+	out.kind = OPND_REG;
+	out.base = _op_reg_name(reg, size);
+	return out;
+}
 int _var_size(Variable *var) {
 	if (var->location == LOC_LITL) {
 		return -1;
@@ -823,7 +1453,7 @@ int _var_size(Variable *var) {
 	size_t count = var->ptr_chain.count;
 	int *ptype;
 	while(count > 0) {
-		ptype = vect_get(&var->ptr_chain, count - 1);
+		ptype = ptrc_get(&var->ptr_chain, count - 1);
 		if (*ptype != PTYPE_REF) {
 			return 8;
 		}
@@ -845,7 +1475,7 @@ int _var_strip_size(Variable *var) {
 	size_t count = var->ptr_chain.count - 1;
 	int *ptype;
 	while(count > 0) {
-		ptype = vect_get(&var->ptr_chain, count - 1);
+		ptype = ptrc_get(&var->ptr_chain, count - 1);
 		if (*ptype != PTYPE_REF) {
 			return 8;
 		}
@@ -875,54 +1505,52 @@ char *mod_label_prefix(Module *m);
 // for address generation
 char *_var_get_datalabel(Variable *var) {
 	Vector v = vect_from_string("");
-	vect_push_free_string(&v, mod_label_prefix(var->mod));
-	vect_push_string(&v, var->name);
+	vect_push_string(&v, mod_label_prefix(var->mod));
+	vect_push_string(&v, sym_str(var->name));
 	return vect_as_string(&v);
 }
 
+// Same, but written straight to the output
+void _var_push_datalabel(Rope *r, Variable *var) {
+	rope_push_string(r, mod_label_prefix(var->mod));
+	rope_push_string(r, sym_str(var->name));
+}
 // Gets the location of a variable. Can not get the location
 // properly if the variable is a reference.
-char *_op_get_location(Variable *var) {
-	char *out = NULL;
-	
+Operand _op_location(Variable *var) {
 	if (var->location == LOC_LITL) {
-		out = int_to_str(var->offset);
+		return _op_imm(var->offset);
 	} else if(var->location == LOC_STCK) {
 		// Invert because stack grows down (and stack index starts at 1)
-		out = _gen_address("", "rbp", "", 0, var->offset, false);
+		return _op_mem("", "rbp", NULL, 0, var->offset);
 	} else if (var->location == LOC_DATA) {
 		// Stored in data sec
-		char *name = _var_get_datalabel(var);
-		out = _gen_address("", name, "", 0, var->offset, true);
-		free(name);
-	} else {
-		// Stored in register.  Our job here is not to assume
-		// what it will be used for (in the case it is a reference)
-		// so we use pure size
-		out = _op_get_register(var->location, _var_pure_size(var));
+		return _op_data("", var, var->offset);
 	}
 
-	return out;
+	// Stored in register.  Our job here is not to assume
+	// what it will be used for (in the case it is a reference)
+	// so we use pure size
+	return _op_reg(var->location, _var_pure_size(var));
 }
-
 // Can only be used on variables contained in a register.
 void var_chg_register(CompData *out, Variable *swap, int new_reg) {
 	if(swap->location == new_reg || swap->location == LOC_DATA || swap->location == LOC_STCK)
 		return;
 
 	if (swap->location == LOC_LITL) {
-		vect_push_string(&out->text, "\tmov ");
-		vect_push_free_string(&out->text, _op_get_register(new_reg, 8));
-		vect_push_string(&out->text, ", ");
-		vect_push_free_string(&out->text, int_to_str(swap->offset));
-		vect_push_string(&out->text, " ; Store literal\n\n");
+		rope_push_string(&out->text, "\tmov ");
+		rope_push_string(&out->text, _op_reg_name(new_reg, 8));
+		rope_push_string(&out->text, ", ");
+		rope_push_int(&out->text, swap->offset);
+		rope_push_string(&out->text, " ; Store literal\n\n");
 		swap->offset = 0;
 	} else {
-		vect_push_string(&out->text, "\tmov ");
-		vect_push_free_string(&out->text, _op_get_register(new_reg, _var_pure_size(swap)));
-		vect_push_string(&out->text, ", ");
-		vect_push_free_string(&out->text, _op_get_register(swap->location, _var_pure_size(swap)));
-		vect_push_string(&out->text, " ; Register swap\n\n");
+		rope_push_string(&out->text, "\tmov ");
+		rope_push_string(&out->text, _op_reg_name(new_reg, _var_pure_size(swap)));
+		rope_push_string(&out->text, ", ");
+		rope_push_string(&out->text, _op_reg_name(swap->location, _var_pure_size(swap)));
+		rope_push_string(&out->text, " ; Register swap\n\n");
 	}
 	
 	swap->location = new_reg;
@@ -945,13 +1573,13 @@ void var_op_dereference(CompData *out, Variable *store, Variable *from) {
 		// Generate initial move (from -> rsi)
 		if (_var_ptr_type(from) > 1)
 			// If in-place array, generate reference by lea
-			vect_push_string(&out->text, "\tlea rsi, ");
+			rope_push_string(&out->text, "\tlea rsi, ");
 		else
 			// If pointer, generate reference by mov
-			vect_push_string(&out->text, "\tmov rsi, ");
+			rope_push_string(&out->text, "\tmov rsi, ");
 		
-		vect_push_free_string(&out->text, _op_get_location(from));
-		vect_push_string(&out->text, "; Move for dereference\n");
+		_op_push(&out->text, _op_location(from));
+		rope_push_string(&out->text, "; Move for dereference\n");
 		// Location -> rsi
 		store->location = 5;
 	}
@@ -962,15 +1590,15 @@ void var_op_dereference(CompData *out, Variable *store, Variable *from) {
 	// Keep de-referencing until we reach the pointer (or ptr_chain bottoms out).
 	int *current;
 	while(store->ptr_chain.count > 1) {
-		current = vect_get(&store->ptr_chain, store->ptr_chain.count - 1);
+		current = ptrc_get(&store->ptr_chain, store->ptr_chain.count - 1);
 		if (*current != PTYPE_REF)
 			break;
-		vect_push_string(&out->text, "\tmov rsi, [rsi] ; Dereference\n");
-		vect_pop(&store->ptr_chain);
+		rope_push_string(&out->text, "\tmov rsi, [rsi] ; Dereference\n");
+		ptrc_pop(&store->ptr_chain);
 	}
 
 	// pointer type -> ref
-	current = vect_get(&store->ptr_chain, store->ptr_chain.count - 1);
+	current = ptrc_get(&store->ptr_chain, store->ptr_chain.count - 1);
 	*current = PTYPE_REF;
 }
 
@@ -983,32 +1611,31 @@ void var_op_index(CompData *out, Variable *store, Variable *from, Variable *inde
 
 	
 	// First, we'll calculate where the index is coming from
-	char *idx_by = NULL;
+	Operand idx_by;
 	if (index->location == LOC_LITL) {
-		idx_by = int_to_str(index->offset);
+		idx_by = _op_imm(index->offset);
 	} else if(_var_ptr_type(index) == PTYPE_REF) {
-		vect_push_string(&out->text, "\tmov rdx, ");
-		vect_push_string(&out->text, _op_get_location(index));
-		vect_push_string(&out->text, " ; !!! DEREF IN INDEX !!!\n");
+		rope_push_string(&out->text, "\tmov rdx, ");
+		_op_push(&out->text, _op_location(index));
+		rope_push_string(&out->text, " ; !!! DEREF IN INDEX !!!\n");
 		
 		int *cur;
 		for(size_t i = index->ptr_chain.count - 1; i > 0; i--) {
-			cur = vect_get(&index->ptr_chain, i - 1);
+			cur = ptrc_get(&index->ptr_chain, i - 1);
 			if (*cur == PTYPE_REF) {
-				vect_push_string(&out->text, "\tmov rdx, [rdx] ; deref\n");
+				rope_push_string(&out->text, "\tmov rdx, [rdx] ; deref\n");
 			} else 
 				break;
 		}
 
-		idx_by = _gen_address(PREFIXES[_var_size(index) - 1], "rdx", "", 0, 0, false);
+		idx_by = _op_mem(PREFIXES[_var_size(index) - 1], "rdx", NULL, 0, 0);
 
 	} else {
 		if (index->location == LOC_STCK || index->location == LOC_DATA) {
-			Vector tmp = vect_from_string(PREFIXES[index->type->size - 1]);
-			vect_push_free_string(&tmp, _op_get_location(index));
-			idx_by = vect_as_string(&tmp);
+			idx_by = _op_location(index);
+			idx_by.prefix = PREFIXES[index->type->size - 1];
 		} else {
-			idx_by = _op_get_register(index->location, _var_size(index));
+			idx_by = _op_reg(index->location, _var_size(index));
 		}
 	}
 
@@ -1018,49 +1645,45 @@ void var_op_index(CompData *out, Variable *store, Variable *from, Variable *inde
 	switch(_var_size(index)) {
 	case 8:
 		// Standard move
-		vect_push_string(&out->text, "\tmov rax, ");
+		rope_push_string(&out->text, "\tmov rax, ");
 		break;
 	case 4:
 		// mov into 4 byte register zeros out upper four bytes of the corrosponding 8 byte register
-		vect_push_string(&out->text, "\tmov eax, ");
+		rope_push_string(&out->text, "\tmov eax, ");
 		break;
 	case 2:
 	case 1:
 		// Zero extension
-		vect_push_string(&out->text, "\tmovzx rax, ");
+		rope_push_string(&out->text, "\tmovzx rax, ");
 		break;
 	default:
-		vect_push_string(&out->text, "\tmov rax, ");
+		rope_push_string(&out->text, "\tmov rax, ");
 	}
 
 	// Get index into rax
-	vect_push_free_string(&out->text, idx_by);
-	vect_push_string(&out->text, " ; Pre-index\n");
+	_op_push(&out->text, idx_by);
+	rope_push_string(&out->text, " ; Pre-index\n");
 	
 	if(_var_strip_size(from) > 1) {
 		// To multiply by the var size, we load the var size into rdx, then
 		// multiply by it.
-		vect_push_string(&out->text, "\tmov rdx, ");
-		vect_push_free_string(&out->text, int_to_str(_var_strip_size(from)));
-		vect_push_string(&out->text, " ; Size of element held by ptr (pre-index)\n");
+		rope_push_string(&out->text, "\tmov rdx, ");
+		rope_push_int(&out->text, _var_strip_size(from));
+		rope_push_string(&out->text, " ; Size of element held by ptr (pre-index)\n");
 		
-		vect_push_string(&out->text, "\tmul rdx ; Index multiplication by data size\n");
+		rope_push_string(&out->text, "\tmul rdx ; Index multiplication by data size\n");
 	}
 
-	vect_push_string(&out->text, "\tlea rsi, ");
+	rope_push_string(&out->text, "\tlea rsi, ");
 	if (_var_first_nonref(from) == PTYPE_PTR) {
-		char *reg = _op_get_register(store->location, 8);
-		vect_push_free_string(&out->text, _gen_address("", reg, "rax", 1, 0, false));
-		free(reg);
+		_op_push(&out->text, _op_mem("", _op_reg_name(store->location, 8), "rax", 1, 0));
 	} else if (_var_first_nonref(from) == PTYPE_ARR) {
 		// Additional offset due to arrays containing a length at the start
-		char *reg = _op_get_register(store->location, 8);
-		vect_push_free_string(&out->text, _gen_address("", reg, "rax", 1, 8, false));
-		free(reg);
+		_op_push(&out->text, _op_mem("", _op_reg_name(store->location, 8), "rax", 1, 8));
 	} else {
-		vect_push_string(&out->text, "rsi ; COMPILER ERROR!");
+		rope_push_string(&out->text, "rsi ; COMPILER ERROR!");
 	}
-	vect_push_string(&out->text, " ; Index complete.\n\n");
+	rope_push_string(&out->text, " ; Index complete.\n\n");
 	store->location = 5;
 }
 
@@ -1080,63 +1703,63 @@ void var_op_pure_set(CompData *out, Variable *store, Variable *from) {
 	}
 
 	if (from->location == LOC_LITL) {
-		vect_push_string(&out->text, "\tmov ");
+		rope_push_string(&out->text, "\tmov ");
 
 		if (store->location < 1) {
 			// Must be done in case of a very large value
-			vect_push_string(&out->text, "rsi, ");
-			vect_push_free_string(&out->text, _op_get_location(from));
-			vect_push_string(&out->text, "\n");
+			rope_push_string(&out->text, "rsi, ");
+			_op_push(&out->text, _op_location(from));
+			rope_push_string(&out->text, "\n");
 			// Store to data
-			vect_push_string(&out->text, "\tmov ");
-			vect_push_string(&out->text, PREFIXES[_var_pure_size(store) - 1]);
-			vect_push_free_string(&out->text, _op_get_location(store));
-			vect_push_string(&out->text, ", ");
-			vect_push_free_string(&out->text, _op_get_register(5, _var_pure_size(store)));
-			vect_push_string(&out->text, "; literal move\n\n");
+			rope_push_string(&out->text, "\tmov ");
+			rope_push_string(&out->text, PREFIXES[_var_pure_size(store) - 1]);
+			_op_push(&out->text, _op_location(store));
+			rope_push_string(&out->text, ", ");
+			rope_push_string(&out->text, _op_reg_name(5, _var_pure_size(store)));
+			rope_push_string(&out->text, "; literal move\n\n");
 		} else {
-			vect_push_free_string(&out->text, _op_get_location(store));
-			vect_push_string(&out->text, ", ");
-			vect_push_free_string(&out->text, _op_get_location(from));
-			vect_push_string(&out->text, "; literal move\n\n");
+			_op_push(&out->text, _op_location(store));
+			rope_push_string(&out->text, ", ");
+			_op_push(&out->text, _op_location(from));
+			rope_push_string(&out->text, "; literal move\n\n");
 		}
 		
 	} else if (!is_inbuilt(from->type->name) && from->ptr_chain.count == 0) {
 		// Pure struct move
-		vect_push_string(&out->text, "\tlea rsi, ");
-		vect_push_free_string(&out->text, _op_get_location(from));
-		vect_push_string(&out->text, "\n");
+		rope_push_string(&out->text, "\tlea rsi, ");
+		_op_push(&out->text, _op_location(from));
+		rope_push_string(&out->text, "\n");
 
-		vect_push_string(&out->text, "\tlea rdi, ");
-		vect_push_free_string(&out->text, _op_get_location(store));
-		vect_push_string(&out->text, "\n");
+		rope_push_string(&out->text, "\tlea rdi, ");
+		_op_push(&out->text, _op_location(store));
+		rope_push_string(&out->text, "\n");
 
-		vect_push_string(&out->text, "\tmov rcx, ");
-		vect_push_free_string(&out->text, int_to_str(_var_pure_size(from)));
-		vect_push_string(&out->text, "\n");
+		rope_push_string(&out->text, "\tmov rcx, ");
+		rope_push_int(&out->text, _var_pure_size(from));
+		rope_push_string(&out->text, "\n");
 		
-		vect_push_string(&out->text, "\trep movsb ; Move struct complete\n\n");
+		rope_push_string(&out->text, "\trep movsb ; Move struct complete\n\n");
 	} else if (from->location < 1 && store->location < 1) {
 		// Both in memory, use rsi as temp storage for move
-		vect_push_string(&out->text, "\tmov ");
-		vect_push_free_string(&out->text, _op_get_register(5, _var_pure_size(from)));
-		vect_push_string(&out->text, ", ");
-		vect_push_free_string(&out->text, _op_get_location(from));
-		vect_push_string(&out->text, "\n");
-
-		vect_push_string(&out->text, "\tmov ");
-		vect_push_free_string(&out->text, _op_get_location(store));
-		vect_push_string(&out->text, ", ");
-		vect_push_free_string(&out->text, _op_get_register(5, _var_pure_size(from)));
-		vect_push_string(&out->text, " ; Memory swap complete\n\n");
+		rope_push_string(&out->text, "\tmov ");
+		rope_push_string(&out->text, _op_reg_name(5, _var_pure_size(from)));
+		rope_push_string(&out->text, ", ");
+		_op_push(&out->text, _op_location(from));
+		rope_push_string(&out->text, "\n");
+
+		rope_push_string(&out->text, "\tmov ");
+		_op_push(&out->text, _op_location(store));
+		rope_push_string(&out->text, ", ");
+		rope_push_string(&out->text, _op_reg_name(5, _var_pure_size(from)));
+		rope_push_string(&out->text, " ; Memory swap complete\n\n");
 
 	} else {
 		// Register to register
-		vect_push_string(&out->text, "\tmov ");
-		vect_push_free_string(&out->text, _op_get_location(store));
-		vect_push_string(&out->text, ", ");
-		vect_push_free_string(&out->text, _op_get_location(from));
-		vect_push_string(&out->text, "; Register move\n\n");
+		rope_push_string(&out->text, "\tmov ");
+		_op_push(&out->text, _op_location(store));
+		rope_push_string(&out->text, ", ");
+		_op_push(&out->text, _op_location(from));
+		rope_push_string(&out->text, "; Register move\n\n");
 	}
 }
 
@@ -1144,52 +1767,52 @@ void var_op_pure_set(CompData *out, Variable *store, Variable *from) {
 // Specific setting rules for pointers
 void _var_op_set_ptr(CompData *out, Variable *store, Variable *from) {
 	// Pointer coercion should always work
-	char *mov_from;
-	char *mov_to;
+	Operand mov_from;
+	Operand mov_to;
 
 	// First deref from var, then deref store variable, then move.
 	if(_var_ptr_type(store) != PTYPE_REF) {
-		mov_to = _op_get_location(store);
+		mov_to = _op_location(store);
 	} else {
 		// Need to deref
-		vect_push_string(&out->text, "\tmov rdi, ");
-		vect_push_free_string(&out->text, _op_get_location(store));
-		vect_push_string(&out->text, " ; Move for ptr set dest deref\n");
+		rope_push_string(&out->text, "\tmov rdi, ");
+		_op_push(&out->text, _op_location(store));
+		rope_push_string(&out->text, " ; Move for ptr set dest deref\n");
 
 		int *cur;
 		for (size_t i = store->ptr_chain.count - 1; i > 0; i--) {
-			cur = vect_get(&store->ptr_chain, i - 1);
+			cur = ptrc_get(&store->ptr_chain, i - 1);
 			if (*cur == PTYPE_REF) {
-				vect_push_string(&out->text, "\tmov rdi, [rdi]\n");
+				rope_push_string(&out->text, "\tmov rdi, [rdi]\n");
 			} else {
 				break;
 			}
 		}
-		mov_to = _gen_address("", "rdi", "", 0, 0, false);
+		mov_to = _op_mem("", "rdi", NULL, 0, 0);
 	}
 
 	if (_var_ptr_type(from) != PTYPE_REF) {
 		if (from->location > 0 || from->location == LOC_LITL) {
-			mov_from = _op_get_location(from);
+			mov_from = _op_location(from);
 		} else if (store->location > 0 && _var_ptr_type(store) != PTYPE_REF) {
-			mov_from = _op_get_location(from);
+			mov_from = _op_location(from);
 		} else {
-			vect_push_string(&out->text, "\tmov rsi, ");
-			vect_push_free_string(&out->text, _op_get_location(from));
-			vect_push_string(&out->text, " ; Move for ptr set\n");
-			mov_from = _op_get_register(5, 8);
+			rope_push_string(&out->text, "\tmov rsi, ");
+			_op_push(&out->text, _op_location(from));
+			rope_push_string(&out->text, " ; Move for ptr set\n");
+			mov_from = _op_reg(5, 8);
 		}
 	} else {
 		// Need to deref
-		vect_push_string(&out->text, "\tmov rsi, ");
-		vect_push_free_string(&out->text, _op_get_location(from));
-		vect_push_string(&out->text, " ; Move for ptr set source deref\n");
+		rope_push_string(&out->text, "\tmov rsi, ");
+		_op_push(&out->text, _op_location(from));
+		rope_push_string(&out->text, " ; Move for ptr set source deref\n");
 		
 		int *cur;
 		for (size_t i = from->ptr_chain.count - 1; i > 0; i--) {
-			cur = vect_get(&from->ptr_chain, i - 1);
+			cur = ptrc_get(&from->ptr_chain, i - 1);
 			if (*cur == PTYPE_REF) {
-				vect_push_string(&out->text, "\tmov rsi, [rsi]\n");
+				rope_push_string(&out->text, "\tmov rsi, [rsi]\n");
 			} else {
 				break;
 			}
@@ -1197,165 +1820,158 @@ void _var_op_set_ptr(CompData *out, Variable *store, Variable *from) {
 
 		switch (_var_size(from)) {
 		case 1:
-			vect_push_string(&out->text, "\tmovzx rsi, byte [rsi]\n");
+			rope_push_string(&out->text, "\tmovzx rsi, byte [rsi]\n");
 			break;
 		case 2:
-			vect_push_string(&out->text, "\tmovzx rsi, word [rsi]\n");
+			rope_push_string(&out->text, "\tmovzx rsi, word [rsi]\n");
 			break;
 		case 4:
-			vect_push_string(&out->text, "\tmov esi, dword [rsi]\n");
+			rope_push_string(&out->text, "\tmov esi, dword [rsi]\n");
 			break;
 		case 8:
-			vect_push_string(&out->text, "\tmov rsi, [rsi]\n");
+			rope_push_string(&out->text, "\tmov rsi, [rsi]\n");
 			break;
 		}
 
-		mov_from = _op_get_register(5, 8);
+		mov_from = _op_reg(5, 8);
 	}
 
-	vect_push_string(&out->text, "\tmov ");
-	vect_push_string(&out->text, mov_to);
-	vect_push_string(&out->text, ", ");
-	vect_push_free_string(&out->text, mov_from);
-	vect_push_string(&out->text, " ; Ptr set final\n");
+	rope_push_string(&out->text, "\tmov ");
+	_op_push(&out->text, mov_to);
+	rope_push_string(&out->text, ", ");
+	_op_push(&out->text, mov_from);
+	rope_push_string(&out->text, " ; Ptr set final\n");
 
 	if (_var_first_nonref(store) == PTYPE_PTR && _var_first_nonref(from) == PTYPE_ARR) {
-		vect_push_string(&out->text, "\tadd ");
-		if (mov_to[0] == '[')
-			vect_push_string(&out->text, " qword ");
-		vect_push_string(&out->text, mov_to);
-		vect_push_string(&out->text, ", ");
-		vect_push_string(&out->text, "8 ; Reference to first el in array\n\n");
+		rope_push_string(&out->text, "\tadd ");
+		if (mov_to.kind == OPND_MEM)
+			rope_push_string(&out->text, " qword ");
+		_op_push(&out->text, mov_to);
+		rope_push_string(&out->text, ", ");
+		rope_push_string(&out->text, "8 ; Reference to first el in array\n\n");
 	} else {
-		vect_push_string(&out->text, "\n");
+		rope_push_string(&out->text, "\n");
 	}
 
-	free(mov_to);
-	
 	return;
 }
 
-char *_var_get_store(CompData *out, Variable *store) {
+Operand _var_get_store(CompData *out, Variable *store) {
 	if (_var_ptr_type(store) == PTYPE_REF){
-		vect_push_string(&out->text, "\tmov rdi, ");
-		vect_push_free_string(&out->text, _op_get_location(store));
-		vect_push_string(&out->text, " ; pre-deref for inbuilt mov (store)\n");
+		rope_push_string(&out->text, "\tmov rdi, ");
+		_op_push(&out->text, _op_location(store));
+		rope_push_string(&out->text, " ; pre-deref for inbuilt mov (store)\n");
 
 		for(size_t i = store->ptr_chain.count - 1; i > 0; i--){
-			int *cur = vect_get(&store->ptr_chain, i);
+			int *cur = ptrc_get(&store->ptr_chain, i);
 			if (cur == PTYPE_REF) {
-				vect_push_string(&out->text, "\tmov rdi, [rdi] ; deref for mov\n");
+				rope_push_string(&out->text, "\tmov rdi, [rdi] ; deref for mov\n");
 			} else
 				break; // Should not happen
 		}
 
-		return _gen_address(PREFIXES[_var_size(store) - 1], "rdi", "", 0, 0, false);
+		return _op_mem(PREFIXES[_var_size(store) - 1], "rdi", NULL, 0, 0);
 	} else if (store->location == 0) {
-		char *name = _var_get_datalabel(store);
-		return _gen_address(PREFIXES[_var_size(store) - 1], name, "", 0, 0, true);
-		free(name);
+		return _op_data(PREFIXES[_var_size(store) - 1], store, 0);
 	} else if (store->location == LOC_LITL) {
-		vect_push_string(&out->text, "\tmov rdi, ");
-		vect_push_free_string(&out->text, int_to_str(store->offset));
-		vect_push_string(&out->text, "; litl set\n");
+		rope_push_string(&out->text, "\tmov rdi, ");
+		rope_push_int(&out->text, store->offset);
+		rope_push_string(&out->text, "; litl set\n");
 		if (store->type != NULL)
-			return _op_get_register(6, _var_size(store));
-		return _op_get_register(6, 8);
+			return _op_reg(6, _var_size(store));
+		return _op_reg(6, 8);
 		var_end(store);
-		*store = var_init("#store", typ_get_inbuilt("int"));
+		*store = var_init(sym_intern("#store"), typ_get_inbuilt(SYM_INT));
 		store->location = 6;
 	} else if (store->location < 0) {
-		return _gen_address(PREFIXES[_var_size(store) - 1], "rbp", "", 0, store->offset, false);
+		return _op_mem(PREFIXES[_var_size(store) - 1], "rbp", NULL, 0, store->offset);
 	} else {
-		return _op_get_location(store);
+		return _op_location(store);
 	}
 }
 
-char *_var_get_from(CompData *out, Variable *store, Variable *from) {
-	char *mov_from = NULL;
+Operand _var_get_from(CompData *out, Variable *store, Variable *from) {
+	Operand mov_from;
 
 	if (_var_ptr_type(from) == PTYPE_REF) {
-		vect_push_string(&out->text, "\tmov rsi, ");
-		vect_push_free_string(&out->text, _op_get_location(from));
-		vect_push_string(&out->text, " ; pre-deref for inbuilt mov (from)\n");
+		rope_push_string(&out->text, "\tmov rsi, ");
+		_op_push(&out->text, _op_location(from));
+		rope_push_string(&out->text, " ; pre-deref for inbuilt mov (from)\n");
 
 		for(size_t i = from->ptr_chain.count - 1; i > 0; i--){
-			int *cur = vect_get(&from->ptr_chain, i);
+			int *cur = ptrc_get(&from->ptr_chain, i);
 			if (cur == PTYPE_REF) {
-				vect_push_string(&out->text, "\tmov rsi, [rsi] ; deref for mov\n");
+				rope_push_string(&out->text, "\tmov rsi, [rsi] ; deref for mov\n");
 			} else
 				break; // Should not happen
 		}
 		// Final deref (store actual value in rsi)
-		vect_push_string(&out->text, "\tmov ");
-		vect_push_free_string(&out->text, _op_get_register(5, _var_size(from)));
-		vect_push_string(&out->text, ", ");
-		vect_push_string(&out->text, PREFIXES[_var_size(from) - 1]);
-		vect_push_string(&out->text, "[rsi] ; pre-deref for inbuilt mov (from)\n");
+		rope_push_string(&out->text, "\tmov ");
+		rope_push_string(&out->text, _op_reg_name(5, _var_size(from)));
+		rope_push_string(&out->text, ", ");
+		rope_push_string(&out->text, PREFIXES[_var_size(from) - 1]);
+		rope_push_string(&out->text, "[rsi] ; pre-deref for inbuilt mov (from)\n");
 
-		mov_from = _op_get_register(5, _var_size(from));
+		mov_from = _op_reg(5, _var_size(from));
 		
 	} else if (from->location > 0) {
-		mov_from = _op_get_register(from->location, _var_size(from));
+		mov_from = _op_reg(from->location, _var_size(from));
 	} else if (from->location == LOC_LITL) {
 		if (store->location == LOC_LITL) {
-			vect_push_string(&out->text, "\tmov rsi, ");
-			vect_push_free_string(&out->text, int_to_str(from->offset));
-			vect_push_string(&out->text, "; litl set\n");
+			rope_push_string(&out->text, "\tmov rsi, ");
+			rope_push_int(&out->text, from->offset);
+			rope_push_string(&out->text, "; litl set\n");
 			if (store->type != NULL)
-				return _op_get_register(5, store->type->size);
-			return _op_get_register(5, 8); 
+				return _op_reg(5, store->type->size);
+			return _op_reg(5, 8);
 		} else if (store->location < 1 || _var_ptr_type(store) == PTYPE_REF) {
-			vect_push_string(&out->text, "\tmov ");
-			vect_push_free_string(&out->text, _op_get_register(5, _var_size(store)));
-			vect_push_string(&out->text, ", ");
-			vect_push_free_string(&out->text, int_to_str(from->offset));
-			vect_push_string(&out->text, "; litl set for inbuilt mov (from)\n");
-			mov_from = _op_get_register(5, _var_size(store));
+			rope_push_string(&out->text, "\tmov ");
+			rope_push_string(&out->text, _op_reg_name(5, _var_size(store)));
+			rope_push_string(&out->text, ", ");
+			rope_push_int(&out->text, from->offset);
+			rope_push_string(&out->text, "; litl set for inbuilt mov (from)\n");
+			mov_from = _op_reg(5, _var_size(store));
 		} else {
-			mov_from = int_to_str(from->offset);
+			mov_from = _op_imm(from->offset);
 		}
 	} else if (store->location < 1 || _var_ptr_type(store) == PTYPE_REF) {
-		vect_push_string(&out->text, "\tmov ");
-		vect_push_free_string(&out->text, _op_get_register(5, _var_size(from)));
-		vect_push_string(&out->text, ", ");
-		vect_push_string(&out->text, _op_get_location(from));
-		vect_push_string(&out->text, " ; pre-load for mov (from)\n");
+		rope_push_string(&out->text, "\tmov ");
+		rope_push_string(&out->text, _op_reg_name(5, _var_size(from)));
+		rope_push_string(&out->text, ", ");
+		_op_push(&out->text, _op_location(from));
+		rope_push_string(&out->text, " ; pre-load for mov (from)\n");
 
-		mov_from = _op_get_register(5, _var_size(from));
+		mov_from = _op_reg(5, _var_size(from));
 	} else if (from->location == 0) {
 		// from in data sec
-		char *name = _var_get_datalabel(from);
-		mov_from = _gen_address(PREFIXES[_var_size(from) - 1], name, "", 0, 0, true);
-		free(name);
+		mov_from = _op_data(PREFIXES[_var_size(from) - 1], from, 0);
 	} else {
 		// from on stack
-		mov_from = _gen_address(PREFIXES[_var_size(from) - 1], "rbp", "", 0, from->offset, false);
+		mov_from = _op_mem(PREFIXES[_var_size(from) - 1], "rbp", NULL, 0, from->offset);
 	}
 
 	// Match sign of data if required.
 	if (from->location != LOC_LITL && _var_size(from) < _var_size(store)) {
 		// Store larger than from (extend sign)
-		if(from->type->name[0] == 'i' && store->type->name[0] == 'i') {
+		if(sym_str(from->type->name)[0] == 'i' && sym_str(store->type->name)[0] == 'i') {
 			if (_var_size(from) < 4)
-				vect_push_string(&out->text, "\tmovsx rsi, ");
+				rope_push_string(&out->text, "\tmovsx rsi, ");
 			else
-				vect_push_string(&out->text, "\tmovsxd rsi, ");
+				rope_push_string(&out->text, "\tmovsxd rsi, ");
 		} else {
 			if(_var_size(from) < 4)
-				vect_push_string(&out->text, "\tmovzx rsi, ");
+				rope_push_string(&out->text, "\tmovzx rsi, ");
 			else
-				vect_push_string(&out->text, "\tmovzxd rsi, ");
+				rope_push_string(&out->text, "\tmovzxd rsi, ");
 		}
-		vect_push_free_string(&out->text, mov_from);
-		vect_push_string(&out->text, " ; Sign extension for mov\n");
-		mov_from = _op_get_register(5, _var_size(store));
+		_op_push(&out->text, mov_from);
+		rope_push_string(&out->text, " ; Sign extension for mov\n");
+		mov_from = _op_reg(5, _var_size(store));
 	} else if (from->location != LOC_LITL && _var_size(from) > _var_size(store)) {
 		// Store smaller than from (recompute mov_from)
 		if (_var_ptr_type(from) == PTYPE_REF) {
 		} else if (from->location > 0) {
-			free(mov_from);
-			mov_from = _op_get_register(from->location, _var_size(store));
+			mov_from = _op_reg(from->location, _var_size(store));
 		}
 	}
 
@@ -1365,8 +1981,8 @@ char *_var_get_from(CompData *out, Variable *store, Variable *from) {
 // Common func to move one variable to another in the case of two
 // inbuilts
 void _var_op_set_inbuilt(CompData *out, Variable *store, Variable *from) {
-	char *mov_from;
-	char *mov_to;
+	Operand mov_from;
+	Operand mov_to;
 	
 	// Cases for source/dest:
 	// register
@@ -1386,11 +2002,11 @@ void _var_op_set_inbuilt(CompData *out, Variable *store, Variable *from) {
 	mov_to = _var_get_store(out, store);
 	mov_from = _var_get_from(out, store, from);
 
-	vect_push_string(&out->text, "\tmov ");
-	vect_push_free_string(&out->text, mov_to);
-	vect_push_string(&out->text, ", ");
-	vect_push_free_string(&out->text, mov_from);
-	vect_push_string(&out->text, " ; Finish mov_inbuilt\n\n");
+	rope_push_string(&out->text, "\tmov ");
+	_op_push(&out->text, mov_to);
+	rope_push_string(&out->text, ", ");
+	_op_push(&out->text, mov_from);
+	rope_push_string(&out->text, " ; Finish mov_inbuilt\n\n");
 }
 
 // Tries it's best to coerce the data from "from" into a format
@@ -1433,12 +2049,12 @@ void var_op_set(CompData *out, Variable *store, Variable *from) {
 		// since we will be using movsb, we first should mov the from struct into
 		// rsi.
 		if (from->location < 1) {
-			vect_push_string(&out->text, "\tlea rsi, ");
+			rope_push_string(&out->text, "\tlea rsi, ");
 		} else {
-			vect_push_string(&out->text, "\tmov rsi, ");
+			rope_push_string(&out->text, "\tmov rsi, ");
 		}
-		vect_push_free_string(&out->text, _op_get_location(from));
-		vect_push_string(&out->text, " ; Initial mov to rsi\n");
+		_op_push(&out->text, _op_location(from));
+		rope_push_string(&out->text, " ; Initial mov to rsi\n");
 		
 		// Handle the case where the from struct is a reference
 		size_t i = from->ptr_chain.count;
@@ -1446,42 +2062,42 @@ void var_op_set(CompData *out, Variable *store, Variable *from) {
 			i--;
 
 		for (; i > 0; i--) {
-			int *cur = vect_get(&from->ptr_chain, i - 1);
+			int *cur = ptrc_get(&from->ptr_chain, i - 1);
 			if (*cur == PTYPE_REF)
-				vect_push_string(&out->text, "\tlea rsi, [rsi] ; Deref\n");
+				rope_push_string(&out->text, "\tlea rsi, [rsi] ; Deref\n");
 			else
 				break;
 		}
 
 		// load the location of the storeage var into rdi
 		if (store->location < 1) {
-			vect_push_string(&out->text, "\tlea rdi, ");
+			rope_push_string(&out->text, "\tlea rdi, ");
 		} else {
-			vect_push_string(&out->text, "\tmov rdi, ");
+			rope_push_string(&out->text, "\tmov rdi, ");
 		}
-		vect_push_free_string(&out->text, _op_get_location(store));
-		vect_push_string(&out->text, " ; Initial mov to rdi\n");
+		_op_push(&out->text, _op_location(store));
+		rope_push_string(&out->text, " ; Initial mov to rdi\n");
 
 		i = store->ptr_chain.count;
 		if (store->location > 0)
 			i--;
 
 		for (; i > 0; i--) {
-			int *cur = vect_get(&store->ptr_chain, i - 1);
+			int *cur = ptrc_get(&store->ptr_chain, i - 1);
 			if (*cur == PTYPE_REF)
-				vect_push_string(&out->text, "\tlea rsi, [rsi] ; Deref\n");
+				rope_push_string(&out->text, "\tlea rsi, [rsi] ; Deref\n");
 			else
 				break;
 		}
 
 		// We can move up to the minimum number of bytes btwn the two structs
-		vect_push_string(&out->text, "\tmov rcx, ");
+		rope_push_string(&out->text, "\tmov rcx, ");
 		if (_var_size(from) < _var_size(store)) {
-			vect_push_free_string(&out->text, int_to_str(_var_size(from)));
+			rope_push_int(&out->text, _var_size(from));
 		} else {
-			vect_push_free_string(&out->text, int_to_str(_var_size(store)));
+			rope_push_int(&out->text, _var_size(store));
 		}
-		vect_push_string(&out->text, "\n\trep movsb ; Complete struct move\n\n");
+		rope_push_string(&out->text, "\n\trep movsb ; Complete struct move\n\n");
 	}
 }
 
@@ -1496,7 +2112,7 @@ void var_op_reference(CompData *out, Variable *store, Variable *from) {
 	*store = var_copy(from);
 	if (store->ptr_chain.count > 0) {
 		for(size_t i = 0; i < store->ptr_chain.count; i++) {
-			int *cur = vect_get(&store->ptr_chain, i);
+			int *cur = ptrc_get(&store->ptr_chain, i);
 			if (*cur == PTYPE_REF) {
 				*cur = PTYPE_PTR;
 				break;
@@ -1504,7 +2120,7 @@ void var_op_reference(CompData *out, Variable *store, Variable *from) {
 		}
 	} else {
 		int ref = PTYPE_REF;
-		vect_push(&store->ptr_chain, &ref);
+		ptrc_push(&store->ptr_chain, ref);
 	}
 	store->location = 5;
 	store->offset = 0;
@@ -1521,17 +2137,17 @@ void var_op_reference(CompData *out, Variable *store, Variable *from) {
 		return;
 	}
 
-	vect_push_string(&out->text, "\tlea ");
-	vect_push_free_string(&out->text, _op_get_register(5, _var_pure_size(store)));
-	vect_push_string(&out->text, ", ");
-	vect_push_free_string(&out->text, _op_get_location(from));
-	vect_push_string(&out->text, " ; Generate reference\n");
-	vect_push_string(&out->text, "\n");
+	rope_push_string(&out->text, "\tlea ");
+	rope_push_string(&out->text, _op_reg_name(5, _var_pure_size(store)));
+	rope_push_string(&out->text, ", ");
+	_op_push(&out->text, _op_location(from));
+	rope_push_string(&out->text, " ; Generate reference\n");
+	rope_push_string(&out->text, "\n");
 }
 
-Variable var_op_member(CompData *data, Variable *from, char *member) {
+Variable var_op_member(CompData *data, Variable *from, int member) {
 	Variable out = {0};
-	out.name = NULL; // This is how you can check weather we succeeded
+	out.name = SYM_NONE; // This is how you can check weather we succeeded
 	
 	if (from->location == LOC_LITL) {
 		printf("ERROR: Unable to take member from literal value");
@@ -1545,19 +2161,19 @@ Variable var_op_member(CompData *data, Variable *from, char *member) {
 
 	for (size_t i = 0; i < from->type->members.count; i++) {
 		Variable *mem = vect_get(&from->type->members, i);
-		if (strcmp(mem->name, member) == 0) {
+		if (mem->name == member) {
 			out = var_copy(mem);
 			break;
 		}
 	}
 	
-	if (out.name == NULL)
+	if (out.name == SYM_NONE)
 		return out;
 
 	// Copy ptr_chain so when using the variable we follow all references
 	for(size_t i = 0; i < from->ptr_chain.count; i++) {
-		int *cur = vect_get(&from->ptr_chain, i);
-		vect_push(&out.ptr_chain, cur);
+		int *cur = ptrc_get(&from->ptr_chain, i);
+		ptrc_push(&out.ptr_chain, *cur);
 	}
 	
 	// Copy location
@@ -1569,15 +2185,13 @@ Variable var_op_member(CompData *data, Variable *from, char *member) {
 		out.location = 5;
 		var_op_pure_set(data, &out, from);
 	} else if(out.location == LOC_DATA) {
-		free(out.name);
-		Vector name = vect_from_string(from->name);
-		out.name = vect_as_string(&name);
+		out.name = from->name;
 	}
 
 	if (out.location == 5 && out.offset > 0) {
-		vect_push_string(&data->text, "\tadd rsi, ");
-		vect_push_free_string(&data->text, int_to_str(out.offset));
-		vect_push_string(&data->text, "; Member generation in reference\n");
+		rope_push_string(&data->text, "\tadd rsi, ");
+		rope_push_int(&data->text, out.offset);
+		rope_push_string(&data->text, "; Member generation in reference\n");
 		out.offset = 0;
 	} else {
 		// If from is already offset, we should base our new offset on the old one.
@@ -1597,17 +2211,17 @@ void var_op_add(CompData *out, Variable *base, Variable *add) {
 		return;
 	}
 
-	char *add_store;
-	char *add_from;
+	Operand add_store;
+	Operand add_from;
 
 	add_store = _var_get_store(out, base);
 	add_from = _var_get_from(out, base, add);
 
-	vect_push_string(&out->text, "\tadd ");
-	vect_push_free_string(&out->text, add_store);
-	vect_push_string(&out->text, ", ");
-	vect_push_free_string(&out->text, add_from);
-	vect_push_string(&out->text, "; complete add\n\n");
+	rope_push_string(&out->text, "\tadd ");
+	_op_push(&out->text, add_store);
+	rope_push_string(&out->text, ", ");
+	_op_push(&out->text, add_from);
+	rope_push_string(&out->text, "; complete add\n\n");
 }
 
 // Subtracts "sub" from "base" and sets "base" to the result
@@ -1618,17 +2232,17 @@ void var_op_sub(CompData *out, Variable *base, Variable *sub) {
 		return;
 	}
 
-	char *sub_store;
-	char *sub_from;
+	Operand sub_store;
+	Operand sub_from;
 
 	sub_store = _var_get_store(out, base);
 	sub_from = _var_get_from(out, base, sub);
 
-	vect_push_string(&out->text, "\tsub ");
-	vect_push_free_string(&out->text, sub_store);
-	vect_push_string(&out->text, ", ");
-	vect_push_free_string(&out->text, sub_from);
-	vect_push_string(&out->text, "; complete sub\n\n");
+	rope_push_string(&out->text, "\tsub ");
+	_op_push(&out->text, sub_store);
+	rope_push_string(&out->text, ", ");
+	_op_push(&out->text, sub_from);
+	rope_push_string(&out->text, "; complete sub\n\n");
 }
 
 // Ands "base" with "and" and sets "base" to the result
@@ -1640,17 +2254,17 @@ void var_op_and(CompData *out, Variable *base, Variable *and) {
 		return;
 	}
 
-	char *and_store;
-	char *and_from;
+	Operand and_store;
+	Operand and_from;
 
 	and_store = _var_get_store(out, base);
 	and_from = _var_get_from(out, base, and);
 
-	vect_push_string(&out->text, "\tand ");
-	vect_push_free_string(&out->text, and_store);
-	vect_push_string(&out->text, ", ");
-	vect_push_free_string(&out->text, and_from);
-	vect_push_string(&out->text, "; complete and\n\n");
+	rope_push_string(&out->text, "\tand ");
+	_op_push(&out->text, and_store);
+	rope_push_string(&out->text, ", ");
+	_op_push(&out->text, and_from);
+	rope_push_string(&out->text, "; complete and\n\n");
 }
 
 // Ors "base" with "or" and sets "base" to the result
@@ -1662,17 +2276,17 @@ void var_op_or(CompData *out, Variable *base, Variable *or) {
 		return;
 	}
 
-	char *or_store;
-	char *or_from;
+	Operand or_store;
+	Operand or_from;
 
 	or_store = _var_get_store(out, base);
 	or_from = _var_get_from(out, base, or);
 
-	vect_push_string(&out->text, "\tor ");
-	vect_push_free_string(&out->text, or_store);
-	vect_push_string(&out->text, ", ");
-	vect_push_free_string(&out->text, or_from);
-	vect_push_string(&out->text, "; complete or\n\n");
+	rope_push_string(&out->text, "\tor ");
+	_op_push(&out->text, or_store);
+	rope_push_string(&out->text, ", ");
+	_op_push(&out->text, or_from);
+	rope_push_string(&out->text, "; complete or\n\n");
 }
 
 // Xors "base" with "xor" and sets "base" to the result
@@ -1684,17 +2298,17 @@ void var_op_xor(CompData *out, Variable *base, Variable *xor) {
 		return;
 	}
 
-	char *xor_store;
-	char *xor_from;
+	Operand xor_store;
+	Operand xor_from;
 
 	xor_store = _var_get_store(out, base);
 	xor_from = _var_get_from(out, base, xor);
 
-	vect_push_string(&out->text, "\txor ");
-	vect_push_free_string(&out->text, xor_store);
-	vect_push_string(&out->text, ", ");
-	vect_push_free_string(&out->text, xor_from);
-	vect_push_string(&out->text, "; complete xor\n\n");
+	rope_push_string(&out->text, "\txor ");
+	_op_push(&out->text, xor_store);
+	rope_push_string(&out->text, ", ");
+	_op_push(&out->text, xor_from);
+	rope_push_string(&out->text, "; complete xor\n\n");
 }
 
 // nors "base" with "nor" and sets "base" to the result
@@ -1706,19 +2320,19 @@ void var_op_nor(CompData *out, Variable *base, Variable *nor) {
 		return;
 	}
 
-	char *nor_store;
-	char *nor_from;
+	Operand nor_store;
+	Operand nor_from;
 
 	nor_store = _var_get_store(out, base);
 	nor_from = _var_get_from(out, base, nor);
 
-	vect_push_string(&out->text, "\tor ");
-	vect_push_free_string(&out->text, nor_store);
-	vect_push_string(&out->text, ", ");
-	vect_push_free_string(&out->text, nor_from);
-	vect_push_string(&out->text, "\n\tnot ");
-	vect_push_free_string(&out->text, nor_store);
-	vect_push_string(&out->text, " ; Complete nor\n");
+	rope_push_string(&out->text, "\tor ");
+	_op_push(&out->text, nor_store);
+	rope_push_string(&out->text, ", ");
+	_op_push(&out->text, nor_from);
+	rope_push_string(&out->text, "\n\tnot ");
+	_op_push(&out->text, nor_store);
+	rope_push_string(&out->text, " ; Complete nor\n");
 }
 
 // nands "base" with "nand" and sets "base" to the result
@@ -1731,16 +2345,16 @@ void var_op_nand(CompData *out, Variable *base, Variable *nand) {
 		return;
 	}
 
-	char *nand_store = _var_get_store(out, base);
-	char *nand_from = _var_get_from(out, base, nand);
+	Operand nand_store = _var_get_store(out, base);
+	Operand nand_from = _var_get_from(out, base, nand);
 
-	vect_push_string(&out->text, "\tand ");
-	vect_push_free_string(&out->text, nand_store);
-	vect_push_string(&out->text, ", ");
-	vect_push_free_string(&out->text, nand_from);
-	vect_push_string(&out->text, "\n\tnot ");
-	vect_push_free_string(&out->text, nand_store);
-	vect_push_string(&out->text, " ; Complete nand\n");
+	rope_push_string(&out->text, "\tand ");
+	_op_push(&out->text, nand_store);
+	rope_push_string(&out->text, ", ");
+	_op_push(&out->text, nand_from);
+	rope_push_string(&out->text, "\n\tnot ");
+	_op_push(&out->text, nand_store);
+	rope_push_string(&out->text, " ; Complete nand\n");
 }
 
 // xands "base" with "xand" and sets "base" to the result
@@ -1752,16 +2366,16 @@ void var_op_xand(CompData *out, Variable *base, Variable *xand) {
 		return;
 	}
 
-	char *xand_store = _var_get_store(out, base);
-	char *xand_from = _var_get_from(out, base, xand);
+	Operand xand_store = _var_get_store(out, base);
+	Operand xand_from = _var_get_from(out, base, xand);
 
-	vect_push_string(&out->text, "\txor ");
-	vect_push_free_string(&out->text, xand_store);
-	vect_push_string(&out->text, ", ");
-	vect_push_free_string(&out->text, xand_from);
-	vect_push_string(&out->text, "\n\tnot ");
-	vect_push_free_string(&out->text, xand_store);
-	vect_push_string(&out->text, " ; Complete xand\n");
+	rope_push_string(&out->text, "\txor ");
+	_op_push(&out->text, xand_store);
+	rope_push_string(&out->text, ", ");
+	_op_push(&out->text, xand_from);
+	rope_push_string(&out->text, "\n\tnot ");
+	_op_push(&out->text, xand_store);
+	rope_push_string(&out->text, " ; Complete xand\n");
 }
 
 // bit inversion of base
@@ -1772,20 +2386,20 @@ void var_op_not(CompData *out, Variable *base) {
 		return;
 	}
 
-	char *not_store = _var_get_store(out, base);
-	if (base->type != NULL && strcmp(base->type->name, "bool") == 0) {
+	Operand not_store = _var_get_store(out, base);
+	if (base->type != NULL && base->type->name == SYM_BOOL) {
 		// boolean not
-		vect_push_string(&out->text, "\tnot ");
-		vect_push_string(&out->text, not_store);
-		vect_push_string(&out->text, "\n");
-		vect_push_string(&out->text, "\tand ");
-		vect_push_free_string(&out->text, not_store);
-		vect_push_string(&out->text, ", 1 ; Complete and\n");
+		rope_push_string(&out->text, "\tnot ");
+		_op_push(&out->text, not_store);
+		rope_push_string(&out->text, "\n");
+		rope_push_string(&out->text, "\tand ");
+		_op_push(&out->text, not_store);
+		rope_push_string(&out->text, ", 1 ; Complete and\n");
 	} else {
 		// normal not
-		vect_push_string(&out->text, "\tnot ");
-		vect_push_free_string(&out->text, not_store);
-		vect_push_string(&out->text, " ; Complete not\n");
+		rope_push_string(&out->text, "\tnot ");
+		_op_push(&out->text, not_store);
+		rope_push_string(&out->text, " ; Complete not\n");
 	}
 }
 
@@ -1793,21 +2407,21 @@ void var_op_not(CompData *out, Variable *base) {
 void var_op_test(CompData *out, Variable *base) {
 
 	if(base->location == LOC_LITL) {
-		vect_push_string(&out->text, "\tmov rax, ");
-		vect_push_free_string(&out->text, int_to_str(base->offset));
-		vect_push_string(&out->text, "\n");
-		vect_push_string(&out->text, "\ttest rax, rax ; lit test\n\n");
+		rope_push_string(&out->text, "\tmov rax, ");
+		rope_push_int(&out->text, base->offset);
+		rope_push_string(&out->text, "\n");
+		rope_push_string(&out->text, "\ttest rax, rax ; lit test\n\n");
 		return;
 	}
 
-	char *test_store = _var_get_store(out, base);
-	char *test_from = _var_get_from(out, base, base);
+	Operand test_store = _var_get_store(out, base);
+	Operand test_from = _var_get_from(out, base, base);
 
-	vect_push_string(&out->text, "\ttest ");
-	vect_push_free_string(&out->text, test_store);
-	vect_push_string(&out->text, ", ");
-	vect_push_free_string(&out->text, test_from);
-	vect_push_string(&out->text, " ; Complete test\n");
+	rope_push_string(&out->text, "\ttest ");
+	_op_push(&out->text, test_store);
+	rope_push_string(&out->text, ", ");
+	_op_push(&out->text, test_from);
+	rope_push_string(&out->text, " ; Complete test\n");
 }
 
 // bit shift base left by "bsl"
@@ -1819,11 +2433,11 @@ void var_op_bsl(CompData *out, Variable *base, Variable *bsl) {
 		return;
 	}
 
-	char *bsl_store = _var_get_store(out, base);
+	Operand bsl_store = _var_get_store(out, base);
 
-	char *bsl_from;
+	Operand bsl_from;
 	if (bsl->location == LOC_LITL) {
-		bsl_from = int_to_str(bsl->offset % 128);
+		bsl_from = _op_imm(bsl->offset % 128);
 	} else {
 		Variable cx = var_copy(bsl);
 		cx.offset = 0;
@@ -1831,15 +2445,15 @@ void var_op_bsl(CompData *out, Variable *base, Variable *bsl) {
 		cx.location = 3;
 		var_op_pure_set(out, &cx, bsl);
 		var_end(&cx);
-		bsl_from = _op_get_register(3, 1);
+		bsl_from = _op_reg(3, 1);
 	}
 	
 	// Signed and unsigned shift are the same
-	vect_push_string(&out->text, "\tshl ");
-	vect_push_free_string(&out->text, bsl_store);
-	vect_push_string(&out->text, ", ");
-	vect_push_free_string(&out->text, bsl_from);
-	vect_push_string(&out->text, " ; Complete shift left\n");
+	rope_push_string(&out->text, "\tshl ");
+	_op_push(&out->text, bsl_store);
+	rope_push_string(&out->text, ", ");
+	_op_push(&out->text, bsl_from);
+	rope_push_string(&out->text, " ; Complete shift left\n");
 }
 
 // bit shift base right by "bsr"
@@ -1851,10 +2465,10 @@ void var_op_bsr(CompData *out, Variable *base, Variable *bsr) {
 		return;
 	}
 
-	char *bsr_store = _var_get_store(out, base);
-	char *bsr_from;
+	Operand bsr_store = _var_get_store(out, base);
+	Operand bsr_from;
 	if (bsr->location == LOC_LITL) {
-		bsr_from = int_to_str(bsr->offset % 256);
+		bsr_from = _op_imm(bsr->offset % 256);
 	} else {
 		Variable cx = var_copy(bsr);
 		cx.offset = 0;
@@ -1862,63 +2476,63 @@ void var_op_bsr(CompData *out, Variable *base, Variable *bsr) {
 		cx.location = 3;
 		var_op_pure_set(out, &cx, bsr);
 		var_end(&cx);
-		bsr_from = _op_get_register(3, 1);
+		bsr_from = _op_reg(3, 1);
 	}
 	
-	if (is_inbuilt(base->type->name) && base->type->name[0] == 'i') {
+	if (is_inbuilt(base->type->name) && sym_str(base->type->name)[0] == 'i') {
 		// integer shift
-		vect_push_string(&out->text, "\tsar ");
+		rope_push_string(&out->text, "\tsar ");
 	} else {
 		// unsigned shift
-		vect_push_string(&out->text, "\tshr ");
+		rope_push_string(&out->text, "\tshr ");
 	}
-	vect_push_free_string(&out->text, bsr_store);
-	vect_push_string(&out->text, ", ");
-	vect_push_free_string(&out->text, bsr_from);
-	vect_push_string(&out->text, " ; Complete not\n");
+	_op_push(&out->text, bsr_store);
+	rope_push_string(&out->text, ", ");
+	_op_push(&out->text, bsr_from);
+	rope_push_string(&out->text, " ; Complete not\n");
 }
 
 Variable var_op_cmpbase(CompData *out, Variable *base, Variable *cmp, char *cc) {
 
-	char *store = _var_get_store(out, base);
+	Operand store = _var_get_store(out, base);
 
 	int tmp_loc = base->location;
 	if (cmp->location == LOC_LITL) {
 		base->location = LOC_LITL;
 	}
 	
-	char *from = _var_get_from(out, base, cmp);
+	Operand from = _var_get_from(out, base, cmp);
 	
 	if (cmp->location == LOC_LITL) {
 		base->location = tmp_loc;
 	}
 
 	// cmp
-	vect_push_string(&out->text, "\tcmp ");
-	vect_push_free_string(&out->text, store);
-	vect_push_string(&out->text, ", ");
-	vect_push_free_string(&out->text, from);
-	vect_push_string(&out->text, "\n");
+	rope_push_string(&out->text, "\tcmp ");
+	_op_push(&out->text, store);
+	rope_push_string(&out->text, ", ");
+	_op_push(&out->text, from);
+	rope_push_string(&out->text, "\n");
 	
 	// prime rax and rdx
-	vect_push_string(&out->text, "\tmov rax, 0\n");
-	vect_push_string(&out->text, "\tmov rdx, 1\n");
+	rope_push_string(&out->text, "\tmov rax, 0\n");
+	rope_push_string(&out->text, "\tmov rdx, 1\n");
 	
 	// Store bool value in rax and test so jumps make sense
-	vect_push_string(&out->text, "\tcmov");
-	vect_push_string(&out->text, cc);
-	vect_push_string(&out->text, " rax, rdx ; bool gen\n");
-	vect_push_string(&out->text, "\ttest rax, rax ; less than test\n\n");
+	rope_push_string(&out->text, "\tcmov");
+	rope_push_string(&out->text, cc);
+	rope_push_string(&out->text, " rax, rdx ; bool gen\n");
+	rope_push_string(&out->text, "\ttest rax, rax ; less than test\n\n");
 
 	// Generate variable
-	Variable v = var_init("#bool", typ_get_inbuilt("bool"));
+	Variable v = var_init(sym_intern("#bool"), typ_get_inbuilt(SYM_BOOL));
 	v.location = 1;
 	return v;
 }
 
 void var_op_le(CompData *out, Variable *base, Variable *cmp) {
 	Variable tmp;
-	if (base->location == LOC_LITL || (is_inbuilt(base->type->name) && base->type->name[0] == 'i')) {
+	if (base->location == LOC_LITL || (is_inbuilt(base->type->name) && sym_str(base->type->name)[0] == 'i')) {
 		// int compare
 		tmp = var_op_cmpbase(out, base, cmp, "le");
 	} else {
@@ -1930,7 +2544,7 @@ void var_op_le(CompData *out, Variable *base, Variable *cmp) {
 
 void var_op_ge(CompData *out, Variable *base, Variable *cmp) {
 	Variable tmp;
-	if (base->location == LOC_LITL || (is_inbuilt(base->type->name) && base->type->name[0] == 'i')) {
+	if (base->location == LOC_LITL || (is_inbuilt(base->type->name) && sym_str(base->type->name)[0] == 'i')) {
 		// int compare
 		tmp = var_op_cmpbase(out, base, cmp, "ge");
 	} else {
@@ -1942,7 +2556,7 @@ void var_op_ge(CompData *out, Variable *base, Variable *cmp) {
 
 void var_op_lt(CompData *out, Variable *base, Variable *cmp) {
 	Variable tmp;
-	if (base->location == LOC_LITL || (is_inbuilt(base->type->name) && base->type->name[0] == 'i')) {
+	if (base->location == LOC_LITL || (is_inbuilt(base->type->name) && sym_str(base->type->name)[0] == 'i')) {
 		// int compare
 		tmp = var_op_cmpbase(out, base, cmp, "l");
 	} else {
@@ -1954,7 +2568,7 @@ void var_op_lt(CompData *out, Variable *base, Variable *cmp) {
 
 void var_op_gt(CompData *out, Variable *base, Variable *cmp) {
 	Variable tmp;
-	if (base->location == LOC_LITL || (is_inbuilt(base->type->name) && base->type->name[0] == 'i')) {
+	if (base->location == LOC_LITL || (is_inbuilt(base->type->name) && sym_str(base->type->name)[0] == 'i')) {
 		// int compare
 		tmp = var_op_cmpbase(out, base, cmp, "g");
 	} else {
@@ -1980,20 +2594,20 @@ void var_op_inc(CompData *out, Variable *lhs) {
 	if (lhs->location == LOC_LITL) {
 		lhs->offset++;
 	}
-	char *store = _var_get_store(out, lhs);
-	vect_push_string(&out->text, "\tinc ");
-	vect_push_free_string(&out->text, store);
-	vect_push_string(&out->text, " ; Increment\n\n");
+	Operand store = _var_get_store(out, lhs);
+	rope_push_string(&out->text, "\tinc ");
+	_op_push(&out->text, store);
+	rope_push_string(&out->text, " ; Increment\n\n");
 }
 
 void var_op_dec(CompData *out, Variable *lhs) {
 	if (lhs->location == LOC_LITL) {
 		lhs->offset--;
 	}
-	char *store = _var_get_store(out, lhs);
-	vect_push_string(&out->text, "\tdec ");
-	vect_push_free_string(&out->text, store);
-	vect_push_string(&out->text, " ; Decrement\n\n");
+	Operand store = _var_get_store(out, lhs);
+	rope_push_string(&out->text, "\tdec ");
+	_op_push(&out->text, store);
+	rope_push_string(&out->text, " ; Decrement\n\n");
 }
 
 // Multiplies "base" by "mul" and sets "base" to the result.
@@ -2008,65 +2622,65 @@ void var_op_mul(CompData *out, Variable *base, Variable *mul) {
 		var_chg_register(out, mul, 3);
 	}
 
-	if(base->type->name[0] == 'i') {
+	if(sym_str(base->type->name)[0] == 'i') {
 		// Integer mul
-		char *store = _var_get_store(out, base);
-		vect_push_string(&out->text, "\tmov ");
-		vect_push_free_string(&out->text, _op_get_register(1, _var_size(base)));
-		vect_push_string(&out->text, ", ");
-		vect_push_string(&out->text, store);
-		vect_push_string(&out->text, "; pre-mul mov\n");
+		Operand store = _var_get_store(out, base);
+		rope_push_string(&out->text, "\tmov ");
+		rope_push_string(&out->text, _op_reg_name(1, _var_size(base)));
+		rope_push_string(&out->text, ", ");
+		_op_push(&out->text, store);
+		rope_push_string(&out->text, "; pre-mul mov\n");
 
 		if (mul->location == LOC_LITL) {
-			vect_push_string(&out->text, "\tmov rcx, ");
-			vect_push_free_string(&out->text, int_to_str(mul->offset));
-			vect_push_string(&out->text, "; literal load\n");
+			rope_push_string(&out->text, "\tmov rcx, ");
+			rope_push_int(&out->text, mul->offset);
+			rope_push_string(&out->text, "; literal load\n");
 
-			vect_push_string(&out->text, "\timul ");
-			vect_push_free_string(&out->text, _op_get_register(3, _var_size(base)));
-			vect_push_string(&out->text, "; imul\n");
+			rope_push_string(&out->text, "\timul ");
+			rope_push_string(&out->text, _op_reg_name(3, _var_size(base)));
+			rope_push_string(&out->text, "; imul\n");
 		} else {
-			char *from = _var_get_from(out, base, mul);
-			vect_push_string(&out->text, "\timul ");
-			vect_push_free_string(&out->text, from);
-			vect_push_string(&out->text, "; imul\n");
+			Operand from = _var_get_from(out, base, mul);
+			rope_push_string(&out->text, "\timul ");
+			_op_push(&out->text, from);
+			rope_push_string(&out->text, "; imul\n");
 		}
 		
 		// move back after mul
-		vect_push_string(&out->text, "\tmov ");
-		vect_push_free_string(&out->text, store);
-		vect_push_string(&out->text, ", ");
-		vect_push_free_string(&out->text, _op_get_register(1, _var_size(base)));
-		vect_push_string(&out->text, "; post-mul mov\n");
+		rope_push_string(&out->text, "\tmov ");
+		_op_push(&out->text, store);
+		rope_push_string(&out->text, ", ");
+		rope_push_string(&out->text, _op_reg_name(1, _var_size(base)));
+		rope_push_string(&out->text, "; post-mul mov\n");
 	} else {
-		char *store = _var_get_store(out, base);
-		vect_push_string(&out->text, "\tmov ");
-		vect_push_free_string(&out->text, _op_get_register(1, _var_size(base)));
-		vect_push_string(&out->text, ", ");
-		vect_push_string(&out->text, store);
-		vect_push_string(&out->text, "; pre-mul mov\n");
+		Operand store = _var_get_store(out, base);
+		rope_push_string(&out->text, "\tmov ");
+		rope_push_string(&out->text, _op_reg_name(1, _var_size(base)));
+		rope_push_string(&out->text, ", ");
+		_op_push(&out->text, store);
+		rope_push_string(&out->text, "; pre-mul mov\n");
 
 		if (mul->location == LOC_LITL) {
-			vect_push_string(&out->text, "\tmov rcx, ");
-			vect_push_free_string(&out->text, int_to_str(mul->offset));
-			vect_push_string(&out->text, "; literal load\n");
+			rope_push_string(&out->text, "\tmov rcx, ");
+			rope_push_int(&out->text, mul->offset);
+			rope_push_string(&out->text, "; literal load\n");
 
-			vect_push_string(&out->text, "\tmul ");
-			vect_push_free_string(&out->text, _op_get_register(3, _var_size(base)));
-			vect_push_string(&out->text, "; mul\n");
+			rope_push_string(&out->text, "\tmul ");
+			rope_push_string(&out->text, _op_reg_name(3, _var_size(base)));
+			rope_push_string(&out->text, "; mul\n");
 		} else {
-			char *from = _var_get_from(out, base, mul);
-			vect_push_string(&out->text, "\tmul ");
-			vect_push_free_string(&out->text, from);
-			vect_push_string(&out->text, "; mul\n");
+			Operand from = _var_get_from(out, base, mul);
+			rope_push_string(&out->text, "\tmul ");
+			_op_push(&out->text, from);
+			rope_push_string(&out->text, "; mul\n");
 		}
 		
 		// move back after mul
-		vect_push_string(&out->text, "\tmov ");
-		vect_push_free_string(&out->text, store);
-		vect_push_string(&out->text, ", ");
-		vect_push_free_string(&out->text, _op_get_register(1, _var_size(base)));
-		vect_push_string(&out->text, "; post-mul mov\n");
+		rope_push_string(&out->text, "\tmov ");
+		_op_push(&out->text, store);
+		rope_push_string(&out->text, ", ");
+		rope_push_string(&out->text, _op_reg_name(1, _var_size(base)));
+		rope_push_string(&out->text, "; post-mul mov\n");
 	}
 }
 
@@ -2079,82 +2693,82 @@ void var_op_div(CompData *out, Variable *base, Variable *div) {
 	}
 
 	// zero out rdx before divide
-	vect_push_string(&out->text, "\txor rdx, rdx ; Clear rdx for divide\n");
+	rope_push_string(&out->text, "\txor rdx, rdx ; Clear rdx for divide\n");
 
-	char *div_by;
-	if (base->type->name[0] == 'i') {
+	Operand div_by;
+	if (sym_str(base->type->name)[0] == 'i') {
 		// mov into rax
-		char *store = _var_get_store(out, base);
+		Operand store = _var_get_store(out, base);
 		switch(_var_size(base)) {
 		case 4:
-			vect_push_string(&out->text, "\tmovsxd rax, ");
+			rope_push_string(&out->text, "\tmovsxd rax, ");
 			break;
 		case 8:
-			vect_push_string(&out->text, "\tmov rax, ");
+			rope_push_string(&out->text, "\tmov rax, ");
 			break;
 		default:
-			vect_push_string(&out->text, "\tmovsx rax, ");
+			rope_push_string(&out->text, "\tmovsx rax, ");
 			break;
 		}
-		vect_push_free_string(&out->text, store);
-		vect_push_string(&out->text, "; initial mov\n\n");
+		_op_push(&out->text, store);
+		rope_push_string(&out->text, "; initial mov\n\n");
 
 		// Calculate div_by
 		if(_var_size(base) > _var_size(div) && div->location == LOC_LITL) {
-			vect_push_string(&out->text, "\tmov rcx, ");
-			vect_push_free_string(&out->text, int_to_str(div->offset));
-			vect_push_string(&out->text, "\n");
-			div_by = _op_get_register(3, _var_size(base));
+			rope_push_string(&out->text, "\tmov rcx, ");
+			rope_push_int(&out->text, div->offset);
+			rope_push_string(&out->text, "\n");
+			div_by = _op_reg(3, _var_size(base));
 
 		} else {
 			div_by = _var_get_from(out, base, div);
 		}
 
 		// Do div
-		vect_push_string(&out->text, "\tidiv ");
-		vect_push_free_string(&out->text, div_by);
-		vect_push_string(&out->text, "; div\n");
+		rope_push_string(&out->text, "\tidiv ");
+		_op_push(&out->text, div_by);
+		rope_push_string(&out->text, "; div\n");
 
 	} else {
 		// mov into rax
-		char *store = _var_get_store(out, base);
+		Operand store = _var_get_store(out, base);
 		switch(_var_size(base)) {
 		case 4:
-			vect_push_string(&out->text, "\tmov eax, ");
+			rope_push_string(&out->text, "\tmov eax, ");
 			break;
 		case 8:
-			vect_push_string(&out->text, "\tmov rax, ");
+			rope_push_string(&out->text, "\tmov rax, ");
 			break;
 		default:
-			vect_push_string(&out->text, "\tmovzx rax, ");
+			rope_push_string(&out->text, "\tmovzx rax, ");
 		}
-		vect_push_free_string(&out->text, store);
-		vect_push_string(&out->text, "; initial mov\n\n");
+		_op_push(&out->text, store);
+		rope_push_string(&out->text, "; initial mov\n\n");
 		
 		// Calculate div by
 		if(_var_size(base) > _var_size(div) && div->location == LOC_LITL) {
-			vect_push_string(&out->text, "\tmov rcx, ");
-			vect_push_free_string(&out->text, int_to_str(div->offset));
-			vect_push_string(&out->text, "\n");
-			div_by = _op_get_register(3, _var_size(base));
+			rope_push_string(&out->text, "\tmov rcx, ");
+			rope_push_int(&out->text, div->offset);
+			rope_push_string(&out->text, "\n");
+			div_by = _op_reg(3, _var_size(base));
 
 		} else {
 			div_by = _var_get_from(out, base, div);
 		}
 
 		// Do div
-		vect_push_string(&out->text, "\tdiv ");
-		vect_push_free_string(&out->text, div_by);
-		vect_push_string(&out->text, "; div\n");
+		rope_push_string(&out->text, "\tdiv ");
+		_op_push(&out->text, div_by);
+		rope_push_string(&out->text, "; div\n");
 	}
 
 	// Mov back to base
-	char *store = _var_get_store(out, base);
-	vect_push_string(&out->text, "\tmov ");
-	vect_push_free_string(&out->text, store);
-	vect_push_string(&out->text, ", ");
-	vect_push_free_string(&out->text, _op_get_register(1, _var_size(base)));
-	vect_push_string(&out->text, "; final mov for div\n\n");
+	Operand store = _var_get_store(out, base);
+	rope_push_string(&out->text, "\tmov ");
+	_op_push(&out->text, store);
+	rope_push_string(&out->text, ", ");
+	rope_push_string(&out->text, _op_reg_name(1, _var_size(base)));
+	rope_push_string(&out->text, "; final mov for div\n\n");
 
 }
 
@@ -2167,102 +2781,100 @@ void var_op_mod(CompData *out, Variable *base, Variable *mod) {
 	}
 
 	// zero out rdx before divide
-	vect_push_string(&out->text, "\txor rdx, rdx ; Clear rdx for divide\n");
+	rope_push_string(&out->text, "\txor rdx, rdx ; Clear rdx for divide\n");
 	
-	char *div_by;
-	if (base->type->name[0] == 'i') {
+	Operand div_by;
+	if (sym_str(base->type->name)[0] == 'i') {
 		// mov into rax
-		char *store = _var_get_store(out, base);
+		Operand store = _var_get_store(out, base);
 		switch(_var_size(base)) {
 		case 4:
-			vect_push_string(&out->text, "\tmovsxd rax, ");
+			rope_push_string(&out->text, "\tmovsxd rax, ");
 			break;
 		case 8:
-			vect_push_string(&out->text, "\tmov rax, ");
+			rope_push_string(&out->text, "\tmov rax, ");
 			break;
 		default:
-			vect_push_string(&out->text, "\tmovsx rax, ");
+			rope_push_string(&out->text, "\tmovsx rax, ");
 			break;
 		}
-		vect_push_free_string(&out->text, store);
-		vect_push_string(&out->text, "; initial mov\n\n");
+		_op_push(&out->text, store);
+		rope_push_string(&out->text, "; initial mov\n\n");
 
 		// Calculate div_by
 		if(_var_size(base) > _var_size(mod) && mod->location == LOC_LITL) {
-			vect_push_string(&out->text, "\tmov rcx, ");
-			vect_push_free_string(&out->text, int_to_str(mod->offset));
-			vect_push_string(&out->text, "\n");
-			div_by = _op_get_register(3, _var_size(base));
+			rope_push_string(&out->text, "\tmov rcx, ");
+			rope_push_int(&out->text, mod->offset);
+			rope_push_string(&out->text, "\n");
+			div_by = _op_reg(3, _var_size(base));
 
 		} else {
 			div_by = _var_get_from(out, base, mod);
 		}
 
 		// Do div
-		vect_push_string(&out->text, "\tidiv ");
-		vect_push_free_string(&out->text, div_by);
-		vect_push_string(&out->text, "; div\n");
+		rope_push_string(&out->text, "\tidiv ");
+		_op_push(&out->text, div_by);
+		rope_push_string(&out->text, "; div\n");
 
 	} else {
 		// mov into rax
-		char *store = _var_get_store(out, base);
+		Operand store = _var_get_store(out, base);
 		switch(_var_size(base)) {
 		case 4:
-			vect_push_string(&out->text, "\tmov eax, ");
+			rope_push_string(&out->text, "\tmov eax, ");
 			break;
 		case 8:
-			vect_push_string(&out->text, "\tmov rax, ");
+			rope_push_string(&out->text, "\tmov rax, ");
 			break;
 		default:
-			vect_push_string(&out->text, "\tmovzx rax, ");
+			rope_push_string(&out->text, "\tmovzx rax, ");
 		}
-		vect_push_free_string(&out->text, store);
-		vect_push_string(&out->text, "; initial mov\n\n");
+		_op_push(&out->text, store);
+		rope_push_string(&out->text, "; initial mov\n\n");
 
 		// Calculate div by
 		if(_var_size(base) > _var_size(mod) && mod->location == LOC_LITL) {
-			vect_push_string(&out->text, "\tmov rcx, ");
-			vect_push_free_string(&out->text, int_to_str(mod->offset));
-			vect_push_string(&out->text, "\n");
-			div_by = _op_get_register(3, _var_size(base));
+			rope_push_string(&out->text, "\tmov rcx, ");
+			rope_push_int(&out->text, mod->offset);
+			rope_push_string(&out->text, "\n");
+			div_by = _op_reg(3, _var_size(base));
 
 		} else {
 			div_by = _var_get_from(out, base, mod);
 		}
 
 		// Do div
-		vect_push_string(&out->text, "\tdiv ");
-		vect_push_free_string(&out->text, div_by);
-		vect_push_string(&out->text, "; div\n");
+		rope_push_string(&out->text, "\tdiv ");
+		_op_push(&out->text, div_by);
+		rope_push_string(&out->text, "; div\n");
 	}
 
 	// Mov back to base
-	char *store = _var_get_store(out, base);
-	vect_push_string(&out->text, "\tmov ");
-	vect_push_free_string(&out->text, store);
-	vect_push_string(&out->text, ", ");
-	vect_push_free_string(&out->text, _op_get_register(4, _var_size(base)));
-	vect_push_string(&out->text, "; final mov for mod\n\n");
+	Operand store = _var_get_store(out, base);
+	rope_push_string(&out->text, "\tmov ");
+	_op_push(&out->text, store);
+	rope_push_string(&out->text, ", ");
+	rope_push_string(&out->text, _op_reg_name(4, _var_size(base)));
+	rope_push_string(&out->text, "; final mov for mod\n\n");
 }
 
 
 
 // Functions
 
-Function func_init(char *name, Module *module) {
+Function func_init(int name, Module *module) {
 	Function out = {0};
 
-	Vector name_cpy = vect_from_string(name);
-	out.name = vect_as_string(&name_cpy);
+	out.name = name;
 	out.module = module;
-	out.inputs = vect_init(sizeof(Variable));
-	out.outputs = vect_init(sizeof(Variable));
+	out.inputs = vect_init_in(&mod_arena, sizeof(Variable));
+	out.outputs = vect_init_in(&mod_arena, sizeof(Variable));
 
 	return out;
 }
 
 void func_end(Function *func) {
-	free(func->name);
 	func->module = NULL;
 
 	for(size_t i = 0; i < func->inputs.count; i++) {
@@ -2282,85 +2894,102 @@ void func_end(Function *func) {
 
 // Modules
 
-Module mod_init(char *name, Module *parent, bool export) {
+Module mod_init(int name, Module *parent, bool export) {
 	Module out = {0};
 
-	Vector name_cpy = vect_from_string(name);
-	out.name = vect_as_string(&name_cpy);
+	out.name = name;
 	out.parent = parent;
 	out.exported = export;
 
-	out.types = vect_init(sizeof(Type));
-	out.vars = vect_init(sizeof(Variable));
-	out.funcs = vect_init(sizeof(Function));
-	out.submods = vect_init(sizeof(Module));
+	out.types = vect_init_in(&mod_arena, sizeof(Type));
+	out.vars = vect_init_in(&mod_arena, sizeof(Variable));
+	out.funcs = vect_init_in(&mod_arena, sizeof(Function));
+	out.submods = vect_init_in(&mod_arena, sizeof(Module));
+
+	out.type_map = smap_init(&mod_arena);
+	out.var_map = smap_init(&mod_arena);
+	out.func_map = smap_init(&mod_arena);
+	out.sub_map = smap_init(&mod_arena);
+	out.sub_lookup = smap_init(&mod_arena);
+	for (int i = 0; i < 3; i++)
+		out.memo[i] = smap_init(&mod_arena);
 
 	return out;
 }
 
+void mod_add_type(Module *mod, Type *t) {
+	smap_put(&mod->type_map, t->name, mod->types.count);
+	vect_push(&mod->types, t);
+}
+
+void mod_add_var(Module *mod, Variable *v) {
+	smap_put(&mod->var_map, v->name, mod->vars.count);
+	vect_push(&mod->vars, v);
+}
+
+void mod_add_func(Module *mod, Function *f) {
+	smap_put(&mod->func_map, f->name, mod->funcs.count);
+	vect_push(&mod->funcs, f);
+}
+
+void mod_add_sub(Module *mod, Module *sub) {
+	int index = mod->submods.count;
+	smap_put(&mod->sub_map, sub->name, index);
+	smap_put(&mod->sub_lookup, sub->name, index);
+
+	char *name = sym_str(sub->name);
+	if (name != NULL && (strncmp(name, "@@", 2) == 0 || strncmp(name, "_#", 2) == 0))
+		smap_put(&mod->sub_lookup, sym_intern(name + 2), index);
+
+	vect_push(&mod->submods, sub);
+}
+
+// Element of v at the index a module map holds for sym, NULL if none
+void *_mod_map_get(SymMap *m, Vector *v, int sym) {
+	int index = smap_get(m, sym);
+	if (index < 0)
+		return NULL;
+	return vect_get(v, index);
+}
+
 #define FT_VAR 0
 #define FT_FUN 1
 #define FT_TYP 2
 
 void *mod_find_rec(Module *mod, Artifact *art, size_t sub, int find_type) {
 	// Not at end of art, need to go deeper
-	if (sub + 1 < art->count) {
-		char **to_check = vect_get(art, sub);
-
-		Vector e_check = vect_from_string("@@"); // In case it is a variable inside an enum
-		Vector t_check = vect_from_string("_#"); // In case it is a function inside a method block
-		vect_push_string(&e_check, *to_check);
-		vect_as_string(&e_check);
-		vect_push_string(&t_check, *to_check);
-		vect_as_string(&t_check);
-		
-		void *out = NULL;
-		for (size_t i = 0; i < mod->submods.count; i++) {
-			Module *m = vect_get(&(mod->submods), i);
-			if (
-				strcmp(m->name, *to_check) == 0 ||
-				strcmp(m->name, e_check.data) == 0 ||
-				strcmp(m->name, t_check.data) == 0
-			) {
-				out = mod_find_rec(m, art, sub + 1, find_type);
-				break;
-			}
-		}
+	if (sub + 1 < art->segs.count) {
+		// Also finds variables inside an enum ("@@") or functions inside
+		// a method block ("_#")
+		Module *m = _mod_map_get(&mod->sub_lookup, &mod->submods, art_get(art, sub));
 
-		vect_end(&e_check);
-		vect_end(&t_check);
+		void *out = NULL;
+		if (m != NULL)
+			out = mod_find_rec(m, art, sub + 1, find_type);
 
 		if (out != NULL)
 			return out;
-	} else if (art->count > 0) {
-		Vector *search = NULL;
-		char **to_check = vect_get(art, art->count - 1);
+	} else if (art->segs.count > 0) {
+		int chk = art_get(art, art->segs.count - 1);
 
+		void *out = NULL;
 		switch(find_type) {
 		case FT_VAR:
-			search = &(mod->vars);
+			out = _mod_map_get(&mod->var_map, &mod->vars, chk);
 			break;
 		case FT_FUN:
-			search = &(mod->funcs);
+			out = _mod_map_get(&mod->func_map, &mod->funcs, chk);
 			break;
 		case FT_TYP:
-			search = &(mod->types);
+			out = _mod_map_get(&mod->type_map, &mod->types, chk);
 			break;
 		default:
 			printf("FATAL: Compiler error, mod_find_rec called with find_type value %d\n", find_type);
 			return NULL;
 		}
 
-		for (size_t i = 0; i < search->count; i++) {
-			void *e = vect_get(search, i);
-			if (find_type == FT_VAR && strcmp(((Variable *)e)->name, *to_check) == 0) {
-				return e;
-			} else if (find_type == FT_FUN && strcmp(((Function *)e)->name, *to_check) == 0) {
-				return e;
-			} else if (find_type == FT_TYP && strcmp(((Type *)e)->name, *to_check) == 0) {
-				return e;
-			}
-		}
+		if (out != NULL)
+			return out;
 	}
 
 	if (mod->parent == NULL || sub > 0)
@@ -2369,35 +2998,57 @@ void *mod_find_rec(Module *mod, Artifact *art, size_t sub, int find_type) {
 	return mod_find_rec(mod->parent, art, 0, find_type);
 }
 
+// The module tree does not change once phase 1 is done, so phase 2
+// remembers every lookup (including the ones which found nothing) in
+// the module it started from.  Results are kept in mod_memo, and the
+// module's memo maps hold the joined name -> index into it.
+bool mod_memo_on = false;
+Vector mod_memo = {0};
+
+void *_mod_find_memo(Module *mod, Artifact *art, int find_type) {
+	if (!mod_memo_on)
+		return mod_find_rec(mod, art, 0, find_type);
+
+	int key = art_join(art, '.');
+	int index = smap_get(&mod->memo[find_type], key);
+	if (index >= 0)
+		return *(void **)vect_get(&mod_memo, index);
+
+	void *out = mod_find_rec(mod, art, 0, find_type);
+	smap_put(&mod->memo[find_type], key, mod_memo.count);
+	vect_push(&mod_memo, &out);
+	return out;
+}
+
 Type *mod_find_type(Module *mod, Artifact *art) {
 	Type *out = NULL;
 	
-	if (art->count == 1) {
-		char ** name = vect_get(art, 0);
-		out = typ_get_inbuilt(*name);
+	if (art->segs.count == 1) {
+		out = typ_get_inbuilt(art_get(art, 0));
 	}
 
 	if (out == NULL)
-		out = mod_find_rec(mod, art, 0, FT_TYP);
+		out = _mod_find_memo(mod, art, FT_TYP);
 	
 	return out;
 }
 
 Function *mod_find_func(Module *mod, Artifact *art) {
-	return mod_find_rec(mod, art, 0, FT_FUN);
+	return _mod_find_memo(mod, art, FT_FUN);
 }
 
 Variable *mod_find_var(Module *mod, Artifact *art) {
-	return mod_find_rec(mod, art, 0, FT_VAR);
+	return _mod_find_memo(mod, art, FT_VAR);
 }
 
-Module *mod_find_sub(Module *mod, char *chk) {
-	for(size_t i = 0; i < mod->submods.count; i++) {
-		Module *m = vect_get(&mod->submods, i);
-		if(strcmp(m->name, chk) == 0)
-				return m;
-	}
-	return NULL;
+Module *mod_find_sub(Module *mod, int chk) {
+	return _mod_map_get(&mod->sub_map, &mod->submods, chk);
+}
+
+// Whether the module holds the methods of a type (named "_#<type>")
+bool mod_is_method(Module *m) {
+	char *name = sym_str(m->name);
+	return name != NULL && strlen(name) > 1 && name[0] == '_' && name[1] == '#';
 }
 
 void mod_full_path_rec(Module *m, Vector *v) {
@@ -2407,7 +3058,7 @@ void mod_full_path_rec(Module *m, Vector *v) {
 	char dot = '.';
 	if(v->count > 0)
 		vect_push(v, &dot);
-	vect_push_string(v, m->name);
+	vect_push_string(v, sym_str(m->name));
 }
 
 char *mod_full_path(Module *m) {
@@ -2416,74 +3067,62 @@ char *mod_full_path(Module *m) {
 	return vect_as_string(&out);
 }
 
-Vector _mod_label_prefix(Module *m) {
-	if (m == NULL) {
-		Vector out = vect_from_string("");
-		return out;
-	}
-
-	Vector out = _mod_label_prefix(m->parent);
-	vect_push_string(&out, m->name);
+// Label prefix for everything in the module (every module name from the
+// root down, each followed by a dot).  Built on first use, once phase 1
+// has settled the parent links, then kept.  Do NOT free.
+char *mod_label_prefix(Module *m) {
+	if (m == NULL)
+		return "";
+	if (m->label != NULL)
+		return m->label;
+
+	Vector out = vect_init_in(&mod_arena, sizeof(char));
+	vect_push_string(&out, mod_label_prefix(m->parent));
+	vect_push_string(&out, sym_str(m->name));
 	if (out.count > 0) {
 		vect_push_string(&out, ".");
 	}
-	return out;
-}
 
-char *mod_label_prefix(Module *m) {
-	Vector out = _mod_label_prefix(m);
-	return vect_as_string(&out);
+	m->label = vect_as_string(&out);
+	return m->label;
 }
 
 // Recursive end of all modules. To be called at the end
 // of the compilation on the root module. Cleans everything
 // in the modules except for the tokenizations.
-void mod_deep_end(Module *mod) {
-	free(mod->name);
-
-	for(size_t i = 0; i < mod->vars.count; i++) {
-		Variable *v = vect_get(&(mod->vars), i);
-		var_end(v);
-	}
-
-	for(size_t i = 0; i < mod->funcs.count; i++) {
-		Function *f = vect_get(&(mod->funcs), i);
-		func_end(f);
-	}
-
-	for(size_t i = 0; i < mod->submods.count; i++) {
-		Module *m = vect_get(&(mod->submods), i);
-		mod_deep_end(m);
-	}
-
-	for(size_t i = 0; i < mod->types.count; i++) {
-		Type *t = vect_get(&(mod->types), i);
-		typ_end(t);
-	}
-
-	vect_end(&(mod->vars));
-	vect_end(&(mod->funcs));
-	vect_end(&(mod->submods));
-	vect_end(&(mod->types));
-}
 
 
 
 // Tokenizer
 typedef struct {
-	char *data;
+	char *data; // View of the token's text in the source (not null terminated)
+	int len;    // Length of the token's text
+	int sym;    // Interned text
 	int line, col;
 	int type;
+	int match;  // Index of the matching delimiter (see tok_match_delims), -1 if none
+	unsigned long value; // Numeric and character literals: decoded value
+	char *str;           // String literals: unescaped text (null terminated)
+	int str_len;         // String literals: length of the unescaped text
 } Token;
 
 bool tok_str_eq(Token *tok, const char *cmp) {
 	if (tok == NULL)
 		return false;
-	return strcmp(tok->data, cmp) == 0;
+	return strncmp(tok->data, cmp, tok->len) == 0 && cmp[tok->len] == 0;
 }
 
 bool tok_eq(Token *a, Token *b) {
-	return strcmp(a->data, b->data) == 0 && a->type == b->type;
+	return a->len == b->len && memcmp(a->data, b->data, a->len) == 0 && a->type == b->type;
+}
+
+// Frees a vector of tokens along with their decoded literals
+void tok_stream_end(Vector *tokens) {
+	for (size_t i = 0; i < tokens->count; i++) {
+		Token *t = vect_get(tokens, i);
+		free(t->str);
+	}
+	vect_end(tokens);
 }
 
 #define TT_DEFWORD 0
@@ -2494,300 +3133,939 @@ bool tok_eq(Token *a, Token *b) {
 #define TT_DELIMIT 5
 #define TT_SPLITTR 6
 
-char *KEYWORDS = "module,export,asm,if,else,loop,label,goto,continue,break,return,import,as,using,struct,method,interface,enum,implements,operator,is";
-char *KEYTYPES = "uint8,uint16,uint32,uint64,uint,int8,int16,int32,int64,int,float32,float64,float,comp64,comp,bool,vect,void,type";
-char *LITERALS = "false,true";
-
-char *RESERVED = "~`!@#$%^&*()[]{}+-=\"\'\\|:;/?>.<,";
-
-char *OPS = "~`!%&|^*/+-=.<>@";
-char *MULTI_OPS = "==,&&,||,^^,!==,!&&,!||,!^^,!<,!>,<<,>>,!&,!|,!^,++,--,>==,<==,+=,-=,*=,/=,%=,!=,&=,|=,^=,~=,`=,len";
-
-char *DELIMS = "()[]{}";
-char *MULTI_DELIMS = ";:#";
-
-
-bool in_csv(char *csv, char *match) {
-	int along = 0;
+// Character classes for the lexer, one table lookup per character
+#define CC_SPACE    0x01 // White space
+#define CC_RESERVED 0x02 // Can not appear in a user defined word
+#define CC_OP       0x04 // Single character operator
+#define CC_DELIM    0x08 // Single character delimiter
+#define CC_MDELIM   0x10 // Part of a two character delimiter (";;", "/:", "#/" ...)
+#define CC_OP_EQ    0x20 // Operator when followed by '=' ("+=", "==", ...)
+#define CC_OP_DBL   0x40 // Operator when doubled ("&&", "<<", ...)
+#define CC_OP_NOT   0x80 // Operator when following '!' ("!<", "!&", ...)
+
+unsigned char CHAR_CLASS[256] = {
+	[0] = CC_RESERVED,
+	[' '] = CC_SPACE, ['\t'] = CC_SPACE, ['\n'] = CC_SPACE,
+	['\v'] = CC_SPACE, ['\f'] = CC_SPACE, ['\r'] = CC_SPACE,
+
+	['~'] = CC_RESERVED | CC_OP | CC_OP_EQ,
+	['`'] = CC_RESERVED | CC_OP | CC_OP_EQ,
+	['!'] = CC_RESERVED | CC_OP | CC_OP_EQ,
+	['%'] = CC_RESERVED | CC_OP | CC_OP_EQ,
+	['*'] = CC_RESERVED | CC_OP | CC_OP_EQ,
+	['/'] = CC_RESERVED | CC_OP | CC_OP_EQ,
+	['+'] = CC_RESERVED | CC_OP | CC_OP_EQ | CC_OP_DBL,
+	['-'] = CC_RESERVED | CC_OP | CC_OP_EQ | CC_OP_DBL,
+	['='] = CC_RESERVED | CC_OP | CC_OP_EQ | CC_OP_DBL,
+	['&'] = CC_RESERVED | CC_OP | CC_OP_EQ | CC_OP_DBL | CC_OP_NOT,
+	['|'] = CC_RESERVED | CC_OP | CC_OP_EQ | CC_OP_DBL | CC_OP_NOT,
+	['^'] = CC_RESERVED | CC_OP | CC_OP_EQ | CC_OP_DBL | CC_OP_NOT,
+	['<'] = CC_RESERVED | CC_OP | CC_OP_DBL | CC_OP_NOT,
+	['>'] = CC_RESERVED | CC_OP | CC_OP_DBL | CC_OP_NOT,
+	['.'] = CC_RESERVED | CC_OP,
+	['@'] = CC_RESERVED | CC_OP,
+
+	['('] = CC_RESERVED | CC_DELIM, [')'] = CC_RESERVED | CC_DELIM,
+	['['] = CC_RESERVED | CC_DELIM, [']'] = CC_RESERVED | CC_DELIM,
+	['{'] = CC_RESERVED | CC_DELIM, ['}'] = CC_RESERVED | CC_DELIM,
+
+	[';'] = CC_RESERVED | CC_MDELIM,
+	[':'] = CC_RESERVED | CC_MDELIM,
+	['#'] = CC_RESERVED | CC_MDELIM,
+
+	['$'] = CC_RESERVED, ['"'] = CC_RESERVED, ['\''] = CC_RESERVED,
+	['\\'] = CC_RESERVED, ['?'] = CC_RESERVED, [','] = CC_RESERVED,
+};
 
-	for (int i = 0; csv[i] != 0; i++) {
-		if (csv[i] == ',') {
-			if(along >= 0 && match[along] == 0)
-				return true;
-			along = 0;
-		} else if (along >= 0 && match[along] == csv[i]) {
-			along++;
-		} else {
-			along = -1;
-		}
-	}
-	
-	return along >= 0 && match[along] == 0; 
+int char_class(char c) {
+	return CHAR_CLASS[(unsigned char)c];
 }
 
 bool is_reserved(char c) {
-	return strchr(RESERVED, c) != NULL;
+	return (char_class(c) & CC_RESERVED) != 0;
 }
 
-bool is_delim(char *data) {
-	int l = strlen(data);
-	
-	if (l == 1 && strchr(DELIMS, data[0]) != NULL)
+bool is_delim(char *data, int l) {
+	if (l == 1 && char_class(data[0]) & CC_DELIM)
 		return true;
 	else if (l == 2) {
-		if (strchr(MULTI_DELIMS, data[0]) != NULL)
+		if (char_class(data[0]) & CC_MDELIM)
 			return (data[1] == data[0] && data[0] != '#') || data[1] == '/';
-		else if (strchr(MULTI_DELIMS, data[1]) != NULL)
+		else if (char_class(data[1]) & CC_MDELIM)
 			return (data[0] == '/');
 	}
 	return false;
 }
 
-int token_type(char*data) {
-	int l = strlen(data);
+// Multi character operators, "len" is handled with the words
+bool is_multi_op(char *data, int l) {
+	if (l == 2) {
+		return (data[1] == '=' && char_class(data[0]) & CC_OP_EQ) ||
+			(data[1] == data[0] && char_class(data[0]) & CC_OP_DBL) ||
+			(data[0] == '!' && char_class(data[1]) & CC_OP_NOT);
+	} else if (l == 3) {
+		// "!==", "!&&", "!||", "!^^", "<==", ">=="
+		if (data[0] == '!')
+			return data[1] == data[2] && strchr("=&|^", data[1]) != NULL;
+		return (data[0] == '<' || data[0] == '>') && data[1] == '=' && data[2] == '=';
+	}
+	return false;
+}
+
+bool word_is(char *data, int l, char *word) {
+	return strncmp(data, word, l) == 0 && word[l] == 0;
+}
+
+// Keywords, keytypes, and literals keyed by first character
+int word_type(char *data, int l) {
+		switch (data[0]) {
+		case 'a':
+			if (word_is(data, l, "asm") || word_is(data, l, "as"))
+				return TT_KEYWORD;
+			break;
+		case 'b':
+			if (word_is(data, l, "bool"))
+				return TT_KEYTYPE;
+			if (word_is(data, l, "break"))
+				return TT_KEYWORD;
+			break;
+		case 'c':
+			if (word_is(data, l, "comp64") || word_is(data, l, "comp"))
+				return TT_KEYTYPE;
+			if (word_is(data, l, "continue"))
+				return TT_KEYWORD;
+			break;
+		case 'e':
+			if (word_is(data, l, "export") || word_is(data, l, "else") || word_is(data, l, "enum"))
+				return TT_KEYWORD;
+			break;
+		case 'f':
+			if (word_is(data, l, "float32") || word_is(data, l, "float64") || word_is(data, l, "float"))
+				return TT_KEYTYPE;
+			if (word_is(data, l, "false"))
+				return TT_LITERAL;
+			break;
+		case 'g':
+			if (word_is(data, l, "goto"))
+				return TT_KEYWORD;
+			break;
+		case 'i':
+			if (
+				word_is(data, l, "int8") || word_is(data, l, "int16") || word_is(data, l, "int32") ||
+				word_is(data, l, "int64") || word_is(data, l, "int")
+			)
+				return TT_KEYTYPE;
+			if (
+				word_is(data, l, "if") || word_is(data, l, "import") || word_is(data, l, "interface") ||
+				word_is(data, l, "implements") || word_is(data, l, "is")
+			)
+				return TT_KEYWORD;
+			break;
+		case 'l':
+			if (word_is(data, l, "loop") || word_is(data, l, "label"))
+				return TT_KEYWORD;
+			if (word_is(data, l, "len"))
+				return TT_AUGMENT;
+			break;
+		case 'm':
+			if (word_is(data, l, "module") || word_is(data, l, "method"))
+				return TT_KEYWORD;
+			break;
+		case 'o':
+			if (word_is(data, l, "operator"))
+				return TT_KEYWORD;
+			break;
+		case 'r':
+			if (word_is(data, l, "return"))
+				return TT_KEYWORD;
+			break;
+		case 's':
+			if (word_is(data, l, "struct"))
+				return TT_KEYWORD;
+			break;
+		case 't':
+			if (word_is(data, l, "type"))
+				return TT_KEYTYPE;
+			if (word_is(data, l, "true"))
+				return TT_LITERAL;
+			break;
+		case 'u':
+			if (
+				word_is(data, l, "uint8") || word_is(data, l, "uint16") || word_is(data, l, "uint32") ||
+				word_is(data, l, "uint64") || word_is(data, l, "uint")
+			)
+				return TT_KEYTYPE;
+			if (word_is(data, l, "using"))
+				return TT_KEYWORD;
+			break;
+		case 'v':
+			if (word_is(data, l, "vect") || word_is(data, l, "void"))
+				return TT_KEYTYPE;
+			break;
+		}
+
+	return TT_DEFWORD;
+}
 
+int token_type(char *data, int l) {
 	// Invalid token
 	if (l < 1)
 		return -1;
 	
-	if (is_delim(data))
+	if (is_delim(data, l))
 		return TT_DELIMIT;
 	else if (is_reserved(data[0]) && l == 1) {
-		if (strchr(OPS, data[0]) != NULL)
+		if (char_class(data[0]) & CC_OP)
 			return TT_AUGMENT;
 		else if (data[0] == ',' || data[0] == ';' || data[0] == ':')
 			return TT_SPLITTR;
-	} else if (in_csv(MULTI_OPS, data)) {
-			return TT_AUGMENT;
-	} else if (in_csv(KEYTYPES, data)) {
-		return TT_KEYTYPE;
-	} else if (in_csv(KEYWORDS, data)) {
-		return TT_KEYWORD;
-	} else if (in_csv(LITERALS, data)){
-		return TT_LITERAL;
+	} else if (is_multi_op(data, l)) {
+		return TT_AUGMENT;
+	} else {
+		return word_type(data, l);
 	}
 
 	return TT_DEFWORD;
 }
 
-Token parse_string_literal(int *ch, int *line, int *col, FILE *fin) {
-	char first = *ch;
-	Vector str = vect_init(sizeof(char));
-
-	vect_push(&str, &first);
-	
-	Token out = {0};
-	out.line = *line;
-	out.col = *col;
-	out.type = TT_LITERAL;
-	
-	*ch = fgetc(fin);
-	*col += 1;
-	char add = 0;
-	while (*ch != first && *ch != EOF) {
-		add = *ch;
-		if (*ch == '\\') {
-			vect_push(&str, &add);
-			*ch = fgetc(fin);
-			*col += 1;
-			if (*ch != EOF) {
-				if (*ch == '\n') {
-					*line += 1;
-					*col = 1;
-				}
-				add = *ch;
-				vect_push(&str, &add);
-				*ch = fgetc(fin);
-				*col += 1;
-			}
-		} else {
-			if (*ch == '\n') {
-				*line += 1;
-				*col = 1;
-			}
-			vect_push(&str, &add);
-			*ch = fgetc(fin);
-			*col += 1;
-		}
+// Lexer state - a cursor over a source file held in memory
+typedef struct {
+	char *src;       // Source text
+	size_t len, pos; // Length of the source and cursor position within it
+	int line, col;   // Line and column of the cursor
+} Lexer;
+
+// Span scanning for the lexer.  Each kind counts how many characters from
+// the cursor on belong to a class so that runs can be skipped in one step:
+#define SCAN_BLANK  0 // White space other than new lines
+#define SCAN_WORD   1 // Letters, digits, '_', and non ascii bytes
+#define SCAN_DIGIT  2 // Decimal digits
+#define SCAN_STRING 3 // Anything but the quote, a backslash, or a new line
+// SCAN_WORD only covers the common word characters, stray control
+// characters are left for the caller to check with char_class.
+
+bool _scan_in_class(unsigned char c, int kind, char quote) {
+	switch (kind) {
+		case SCAN_BLANK:
+			return c != '\n' && (char_class(c) & CC_SPACE);
+		case SCAN_WORD:
+			return c >= 0x80 || c == '_' || (c >= '0' && c <= '9') || ((c | 0x20) >= 'a' && (c | 0x20) <= 'z');
+		case SCAN_DIGIT:
+			return c >= '0' && c <= '9';
+		case SCAN_STRING:
+			return c != (unsigned char)quote && c != '\\' && c != '\n';
 	}
+	return false;
+}
 
-	vect_push(&str, &first);
+size_t _scan_scalar(char *src, size_t pos, size_t len, int kind, char quote) {
+	size_t start = pos;
+	while (pos < len && _scan_in_class(src[pos], kind, quote))
+		pos++;
+	return pos - start;
+}
+
+#ifdef LEX_SIMD
+
+// Byte masks are built with unsigned range checks: c in [lo, hi] when
+// (c - lo) == min(c - lo, hi - lo)
+#define _SSE2_RANGE(v, lo, hi) _mm_cmpeq_epi8( \
+	_mm_min_epu8(_mm_sub_epi8(v, _mm_set1_epi8(lo)), _mm_set1_epi8((hi) - (lo))), \
+	_mm_sub_epi8(v, _mm_set1_epi8(lo)))
+#define _AVX2_RANGE(v, lo, hi) _mm256_cmpeq_epi8( \
+	_mm256_min_epu8(_mm256_sub_epi8(v, _mm256_set1_epi8(lo)), _mm256_set1_epi8((hi) - (lo))), \
+	_mm256_sub_epi8(v, _mm256_set1_epi8(lo)))
+
+__m128i _scan_class_sse2(__m128i v, int kind, char quote) {
+	switch (kind) {
+		case SCAN_BLANK:
+			return _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')),
+				_mm_andnot_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n')), _SSE2_RANGE(v, '\t', '\r')));
+		case SCAN_WORD:
+			return _mm_or_si128(
+				_mm_or_si128(_mm_cmplt_epi8(v, _mm_setzero_si128()), _mm_cmpeq_epi8(v, _mm_set1_epi8('_'))),
+				_mm_or_si128(_SSE2_RANGE(v, '0', '9'), _SSE2_RANGE(_mm_or_si128(v, _mm_set1_epi8(0x20)), 'a', 'z')));
+		case SCAN_DIGIT:
+			return _SSE2_RANGE(v, '0', '9');
+		case SCAN_STRING:
+			return _mm_xor_si128(_mm_set1_epi8(-1), _mm_or_si128(
+				_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(quote)), _mm_cmpeq_epi8(v, _mm_set1_epi8('\\'))),
+				_mm_cmpeq_epi8(v, _mm_set1_epi8('\n'))));
+	}
+	return _mm_setzero_si128();
+}
+
+size_t _scan_sse2(char *src, size_t pos, size_t len, int kind, char quote) {
+	size_t start = pos;
+	while (pos + 16 <= len) {
+		__m128i v = _mm_loadu_si128((__m128i *)(src + pos));
+		unsigned int miss = ~_mm_movemask_epi8(_scan_class_sse2(v, kind, quote)) & 0xffff;
+		if (miss != 0)
+			return pos + __builtin_ctz(miss) - start;
+		pos += 16;
+	}
+	return pos - start + _scan_scalar(src, pos, len, kind, quote);
+}
+
+__attribute__((target("avx2")))
+__m256i _scan_class_avx2(__m256i v, int kind, char quote) {
+	switch (kind) {
+		case SCAN_BLANK:
+			return _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')),
+				_mm256_andnot_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n')), _AVX2_RANGE(v, '\t', '\r')));
+		case SCAN_WORD:
+			return _mm256_or_si256(
+				_mm256_or_si256(_mm256_cmpgt_epi8(_mm256_setzero_si256(), v), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('_'))),
+				_mm256_or_si256(_AVX2_RANGE(v, '0', '9'), _AVX2_RANGE(_mm256_or_si256(v, _mm256_set1_epi8(0x20)), 'a', 'z')));
+		case SCAN_DIGIT:
+			return _AVX2_RANGE(v, '0', '9');
+		case SCAN_STRING:
+			return _mm256_xor_si256(_mm256_set1_epi8(-1), _mm256_or_si256(
+				_mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(quote)), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\'))),
+				_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n'))));
+	}
+	return _mm256_setzero_si256();
+}
+
+__attribute__((target("avx2")))
+size_t _scan_avx2(char *src, size_t pos, size_t len, int kind, char quote) {
+	size_t start = pos;
+	while (pos + 32 <= len) {
+		__m256i v = _mm256_loadu_si256((__m256i *)(src + pos));
+		unsigned int miss = ~(unsigned int)_mm256_movemask_epi8(_scan_class_avx2(v, kind, quote));
+		if (miss != 0)
+			return pos + __builtin_ctz(miss) - start;
+		pos += 32;
+	}
+	return pos - start + _scan_sse2(src, pos, len, kind, quote);
+}
+
+#endif
+
+size_t (*_scan_impl)(char *src, size_t pos, size_t len, int kind, char quote) = NULL;
+
+// Picks the widest scanner the cpu supports
+void _scan_init() {
+#ifdef LEX_SIMD
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2"))
+		_scan_impl = _scan_avx2;
+	else
+		_scan_impl = _scan_sse2;
+#else
+	_scan_impl = _scan_scalar;
+#endif
+}
+
+// Number of characters from the cursor on which belong to the kind
+size_t lex_scan(Lexer *lx, int kind, char quote) {
+	if (_scan_impl == NULL)
+		_scan_init();
+	return _scan_impl(lx->src, lx->pos, lx->len, kind, quote);
+}
 
-	if (*ch == first)
-		*ch = fgetc(fin);
+// Reads all of the given file into one null terminated buffer.  The buffer
+// has room past the terminator for the lexer to close an unterminated string.
+char *read_file(FILE *fin, size_t *len) {
+	size_t size = 4096, count = 0;
 
-	out.data = vect_as_string(&str);
+	// Size the buffer from the file if we can, otherwise grow as we go
+	if (fseek(fin, 0, SEEK_END) == 0) {
+		long end = ftell(fin);
+		if (end > 0)
+			size = end + 1;
+		fseek(fin, 0, SEEK_SET);
+	}
+
+	char *out = malloc(size + 2);
+	size_t got;
+	while ((got = fread(out + count, sizeof(char), size - count, fin)) > 0) {
+		count += got;
+		if (count == size) {
+			size *= 2;
+			out = realloc(out, size + 2);
+		}
+	}
 
+	out[count] = 0;
+	*len = count;
 	return out;
 }
 
-Token parse_numeric_literal(int *next, int *line, int *col, FILE *fin) {
-	Token out = {0};
+unsigned long tnsl_parse_number(Token *numeric_literal);
+char tnsl_unquote_char(char *str);
+Vector tnsl_unquote_str(char *literal, int len);
 
-	out.col = *col;
-	out.line = *line;
-	out.type = TT_LITERAL;
+// Decodes a literal up front so evaluation does not have to.  The text
+// must be followed by at least one readable character.
+void tok_decode_literal(Token *t) {
+	if (t->type != TT_LITERAL || t->len < 1)
+		return;
 
-	Vector num = vect_init(sizeof(char));
-	char ch = *next;
-	vect_push(&num, &ch);
-	
-	bool dec = false;
+	if (t->data[0] == '"') {
+		Vector str = tnsl_unquote_str(t->data, t->len);
+		t->str_len = str.count;
+		t->str = vect_as_string(&str);
+	} else if (t->data[0] == '\'') {
+		t->value = tnsl_unquote_char(t->data + 1);
+	} else if (t->data[0] >= '0' && t->data[0] <= '9') {
+		t->value = tnsl_parse_number(t);
+	}
+}
+
+// Points the token at len characters of the source.  Stray nulls end the
+// token's text early.
+void lex_view(Lexer *lx, Token *tok, size_t start, size_t len) {
+	tok->data = lx->src + start;
+	tok->len = strnlen(tok->data, len);
+	tok->sym = sym_intern_n(tok->data, tok->len);
+}
+
+Token parse_string_literal(Lexer *lx) {
+	char first = lx->src[lx->pos];
+	size_t start = lx->pos;
 
-	while (*next != EOF) {
-		*next = fgetc(fin);
-		*col += 1;
+	Token out = {0};
+	out.line = lx->line;
+	out.col = lx->col;
+	out.type = TT_LITERAL;
 
-		if (*next == '.' && dec) {
+	lx->pos++;
+	lx->col++;
+	while (lx->pos < lx->len) {
+		size_t run = lex_scan(lx, SCAN_STRING, first);
+		lx->pos += run;
+		lx->col += run;
+		if (lx->pos >= lx->len || lx->src[lx->pos] == first)
 			break;
-		} else if (*next == '.') {
-			dec = true;
+
+		if (lx->src[lx->pos] == '\\') {
+			lx->pos++;
+			lx->col++;
+			if (lx->pos >= lx->len)
+				break;
 		}
 
-		if (*next < '0' || *next > '9') {
-			break;
-		} else {
-			ch = *next;
-			vect_push(&num, &ch);
+		if (lx->src[lx->pos] == '\n') {
+			lx->line++;
+			lx->col = 1;
 		}
+		lx->pos++;
+		lx->col++;
 	}
 
-	out.data = vect_as_string(&num);
+	// Unterminated strings still get their closing quote, this can only
+	// happen at the end of the source so there is room in the buffer for it
+	if (lx->pos >= lx->len) {
+		lx->src[lx->len] = first;
+		lx->src[lx->len + 1] = 0;
+	}
+
+	lex_view(lx, &out, start, lx->pos - start + 1);
+	tok_decode_literal(&out);
+	lx->pos++;
+
+	return out;
+}
+
+Token parse_numeric_literal(Lexer *lx) {
+	Token out = {0};
+
+	out.col = lx->col;
+	out.line = lx->line;
+	out.type = TT_LITERAL;
+
+	size_t start = lx->pos;
+	lx->pos++;
+	lx->col++;
+
+	size_t run = lex_scan(lx, SCAN_DIGIT, 0);
+	lx->pos += run;
+	lx->col += run;
+
+	lex_view(lx, &out, start, lx->pos - start);
+	tok_decode_literal(&out);
 
 	return out;
 }
 
-void parse_reserved_tokens(int *next, Vector *out, int *line, int *col, FILE *fin) {
+void parse_reserved_tokens(Lexer *lx, Vector *out) {
 	Token tmp = {0};
-	tmp.col = *col;
-	tmp.line = *line;
+	tmp.col = lx->col;
+	tmp.line = lx->line;
 
-	Vector res = vect_init(sizeof(char));
-	char add = *next;
-	vect_push(&res, &add);
+	size_t start = lx->pos;
 
-	*next = fgetc(fin);
-	*col += 1;
+	lx->pos++;
+	lx->col++;
 
-	while (*next != EOF) {
-		add = *next;
+	while (lx->pos < lx->len) {
+		char add = lx->src[lx->pos];
 		
 		if (!is_reserved(add) || add == '"' || add == '\'') {
 			break;
 		}
 
-		vect_push(&res, &add);
-		int after = token_type(vect_as_string(&res));
+		int after = token_type(lx->src + start, strnlen(lx->src + start, lx->pos - start + 1));
 
 		if (after == TT_DEFWORD) {
-			vect_pop(&res);
-			tmp.data = vect_as_string(&res);
-			tmp.type = token_type(tmp.data);
-			vect_push(out, &tmp);
+			// Runs starting with a stray null have no text, these are dropped
+			lex_view(lx, &tmp, start, lx->pos - start);
+			tmp.type = token_type(tmp.data, tmp.len);
+			if (tmp.len > 0)
+				vect_push(out, &tmp);
 			
-			res = vect_init(sizeof(char));
-			vect_push(&res, &add);
-			tmp.col = *col;
+			start = lx->pos;
+			tmp.col = lx->col;
 		}
 
-		*next = fgetc(fin);
-		*col += 1;
+		lx->pos++;
+		lx->col++;
 	}
 	
-	if (res.count > 0) {
-		tmp.data = vect_as_string(&res);
-		tmp.type = token_type(tmp.data);
+	lex_view(lx, &tmp, start, lx->pos - start);
+	tmp.type = token_type(tmp.data, tmp.len);
+	if (tmp.len > 0)
 		vect_push(out, &tmp);
-	}
 }
 
-Token parse_word_token(int *next, int *line, int *col, FILE *fin) {
+Token parse_word_token(Lexer *lx) {
 	Token out = {0}; 
-	out.line = *line;
-	out.col = *col;
+	out.line = lx->line;
+	out.col = lx->col;
 
-	Vector str = vect_init(sizeof(char));
-	char add = *next;
+	size_t start = lx->pos;
+	while (lx->pos < lx->len) {
+		size_t run = lex_scan(lx, SCAN_WORD, 0);
+		lx->pos += run;
+		lx->col += run;
 
-	while (*next != EOF) {
-		if (isspace(*next) != 0 || is_reserved(add)) {
+		// Less common characters which are still part of a word
+		if (lx->pos >= lx->len || char_class(lx->src[lx->pos]) & (CC_SPACE | CC_RESERVED))
 			break;
-		} else {
-			vect_push(&str, &add);
-		}
-
-		*next = fgetc(fin);
-		add = *next;
-		*col += 1;
+		lx->pos++;
+		lx->col++;
 	}
 	
-	out.data = vect_as_string(&str);
+	lex_view(lx, &out, start, lx->pos - start);
 
-	out.type = token_type(out.data);
+	out.type = token_type(out.data, out.len);
 	return out;
 }
 
-void parse_nl_token(Vector *out, int *line, int *col) {
+void parse_nl_token(Lexer *lx, Vector *out) {
 	Token add = {0};
 	
-	add.col = *col;
-	add.line = *line;
+	add.col = lx->col;
+	add.line = lx->line;
 	add.type = TT_SPLITTR;
 
-	add.data = malloc(sizeof(char) * 2);
-	add.data[0] = '\n';
-	add.data[1] = 0;
+	lex_view(lx, &add, lx->pos, 1);
 
 	vect_push(out, &add);
 
-	*col = 1;
-	*line += 1;
+	lx->pos++;
+	lx->col = 1;
+	lx->line++;
 }
 
-void parse_comment(int *ch, FILE *fin) {
-	while(*ch != '\n' && *ch != EOF) {
-		*ch = fgetc(fin);
-	}
+void parse_comment(Lexer *lx) {
+	char *nl = memchr(lx->src + lx->pos, '\n', lx->len - lx->pos);
+	lx->pos = nl != NULL ? (size_t)(nl - lx->src) : lx->len;
 }
 
 
-Vector parse_file(FILE *fin) {
+// Tokenizes len characters of source text.  Tokens point into the source so
+// it must outlive them, and it must have room for two characters past len
+// (see read_file).
+Vector parse_file(char *src, size_t len) {
 	Vector out = vect_init(sizeof(Token));
 
-	int line = 1, col = 1;
-	int check = fgetc(fin);
+	Lexer lx = {src, len, 0, 1, 1};
 	Token add = {0};
 
-	while (check != EOF) {
+	while (lx.pos < lx.len) {
 		add.type = -1;
+		int check = (unsigned char)lx.src[lx.pos];
 
-		if (isspace(check) && check != '\n') {
-			check = fgetc(fin);
-			col++;
+		if (char_class(check) & CC_SPACE && check != '\n') {
+			size_t run = lex_scan(&lx, SCAN_BLANK, 0);
+			lx.pos += run;
+			lx.col += run;
 		} else if (check == '#') {
-			parse_comment(&check, fin);
+			parse_comment(&lx);
 		} else if (check == '\"' || check == '\'') {
-			add = parse_string_literal(&check, &line, &col, fin);
+			add = parse_string_literal(&lx);
 		} else if (check >= '0' && check <= '9') {
-			add = parse_numeric_literal(&check, &line, &col, fin);
+			add = parse_numeric_literal(&lx);
 		} else if (is_reserved(check)) {
-			parse_reserved_tokens(&check, &out, &line, &col, fin);
+			parse_reserved_tokens(&lx, &out);
 		} else if(check != '\n') {
-			add = parse_word_token(&check, &line, &col, fin);
+			add = parse_word_token(&lx);
 		}
 
 		if (add.type >= 0)
 			vect_push(&out, &add);
 
-		if (check == '\n') {
-			parse_nl_token(&out, &line, &col);
-			check = fgetc(fin);
+		if (lx.pos < lx.len && lx.src[lx.pos] == '\n')
+			parse_nl_token(&lx, &out);
+	}
+
+	return out;
+}
+
+// Opening delimiter which a closing delimiter must pair with, block
+// delimiters are all treated as '/'
+char _tok_delim_opener(Token *t) {
+	if (t->len == 1) {
+		switch (t->data[0]) {
+			case ')':
+				return '(';
+			case ']':
+				return '[';
+			case '}':
+				return '{';
+		}
+	} else if (tok_str_eq(t, ";/") || tok_str_eq(t, ";;")) {
+		return '/';
+	}
+	return 0;
+}
+
+char _tok_delim_kind(Token *t) {
+	if (tok_str_eq(t, "(") || tok_str_eq(t, "[") || tok_str_eq(t, "{"))
+		return t->data[0];
+	else if (tok_str_eq(t, "/;") || tok_str_eq(t, ";;"))
+		return '/';
+	return 0;
+}
+
+// Pairs up every delimiter in the token stream.  Openers point forward to
+// their closer and closers point back to their opener, except ";;" which
+// both closes the block before it and opens the next so points forward.
+// Unmatched delimiters are reported and left at -1.  Returns the number of
+// unmatched delimiters.
+int tok_match_delims(Vector *tokens) {
+	Vector open = vect_init(sizeof(size_t));
+	int errors = 0;
+
+	for (size_t i = 0; i < tokens->count; i++) {
+		Token *t = vect_get(tokens, i);
+		t->match = -1;
+		if (t->type != TT_DELIMIT)
+			continue;
+
+		char closes = _tok_delim_opener(t);
+		if (closes != 0) {
+			size_t *top = vect_get(&open, open.count - 1);
+			Token *o = top != NULL ? vect_get(tokens, *top) : NULL;
+
+			if (o != NULL && _tok_delim_kind(o) == closes) {
+				o->match = i;
+				t->match = *top;
+				vect_pop(&open);
+			} else if (closes != '/' || t->data[1] != ';') {
+				printf("Unmatched closing delimiter at {line %d, col %d, \"%.*s\"}\n\n", t->line, t->col, t->len, t->data);
+				errors++;
+			}
+		}
+
+		if (_tok_delim_kind(t) != 0) {
+			t->match = -1;
+			vect_push(&open, &i);
+		}
+	}
+
+	for (size_t i = 0; i < open.count; i++) {
+		Token *t = vect_get(tokens, *(size_t *)vect_get(&open, i));
+		printf("Could not find closing for delimiter (line %d, col %d, \"%.*s\")\n\n", t->line, t->col, t->len, t->data);
+		errors++;
+	}
+
+	vect_end(&open);
+	return errors;
+}
+
+
+// Binary token streams - a file's tokens stored so they can be compiled
+// without lexing the source again.  All numbers are 32 bit little endian.
+//   header:  magic ("TNSLTOK\0"), version, string table size, token count
+//   strings: the text of every distinct token, each followed by a null
+//   records: one per token - string offset, length, line, column, type
+#define TOKBIN_MAGIC "TNSLTOK"
+#define TOKBIN_VERSION 1
+#define TOKBIN_HEADER 20
+#define TOKBIN_RECORD 20
+
+void _tokbin_push32(Vector *out, unsigned int n) {
+	char b[4] = {n & 0xff, (n >> 8) & 0xff, (n >> 16) & 0xff, (n >> 24) & 0xff};
+	vect_push_n(out, b, 4);
+}
+
+unsigned int _tokbin_get32(char *at) {
+	unsigned char *b = (unsigned char *)at;
+	return b[0] | (b[1] << 8) | (b[2] << 16) | ((unsigned int)b[3] << 24);
+}
+
+bool tok_is_binary(char *src, size_t len) {
+	return len >= TOKBIN_HEADER && memcmp(src, TOKBIN_MAGIC, sizeof(TOKBIN_MAGIC)) == 0;
+}
+
+void tok_write_binary(FILE *out, Vector *tokens) {
+	// String table offsets by symbol, so each distinct text is stored once
+	size_t sym_count = sym_strs.count;
+	unsigned int *offsets = calloc(sym_count, sizeof(unsigned int));
+	bool *stored = calloc(sym_count, sizeof(bool));
+
+	Vector strings = vect_init(sizeof(char));
+	Vector records = vect_init(sizeof(char));
+	vect_reserve(&records, tokens->count * TOKBIN_RECORD);
+
+	for (size_t i = 0; i < tokens->count; i++) {
+		Token *t = vect_get(tokens, i);
+		if (!stored[t->sym]) {
+			stored[t->sym] = true;
+			offsets[t->sym] = strings.count;
+			vect_push_nstring(&strings, t->data, t->len);
+			char end = 0;
+			vect_push(&strings, &end);
+		}
+
+		_tokbin_push32(&records, offsets[t->sym]);
+		_tokbin_push32(&records, t->len);
+		_tokbin_push32(&records, t->line);
+		_tokbin_push32(&records, t->col);
+		_tokbin_push32(&records, t->type);
+	}
+
+	Vector header = vect_from_string(TOKBIN_MAGIC);
+	char end = 0;
+	vect_push(&header, &end);
+	_tokbin_push32(&header, TOKBIN_VERSION);
+	_tokbin_push32(&header, strings.count);
+	_tokbin_push32(&header, tokens->count);
+
+	fwrite(header.data, sizeof(char), header.count, out);
+	fwrite(strings.data, sizeof(char), strings.count, out);
+	fwrite(records.data, sizeof(char), records.count, out);
+
+	vect_end(&header);
+	vect_end(&strings);
+	vect_end(&records);
+	free(offsets);
+	free(stored);
+}
+
+// Reads tokens from a binary token stream.  Tokens point into the string
+// table so src must outlive them.  Returns false if the stream is malformed,
+// out is then left without storage.
+bool tok_read_binary(char *src, size_t len, Vector *out) {
+	if (!tok_is_binary(src, len) || _tokbin_get32(src + 8) != TOKBIN_VERSION)
+		return false;
+
+	size_t str_size = _tokbin_get32(src + 12);
+	size_t count = _tokbin_get32(src + 16);
+	if (str_size > len - TOKBIN_HEADER || count != (len - TOKBIN_HEADER - str_size) / TOKBIN_RECORD)
+		return false;
+	if ((len - TOKBIN_HEADER - str_size) % TOKBIN_RECORD != 0 || (str_size > 0 && src[TOKBIN_HEADER + str_size - 1] != 0))
+		return false;
+
+	char *strings = src + TOKBIN_HEADER;
+	char *rec = strings + str_size;
+	*out = vect_init(sizeof(Token));
+	vect_reserve(out, count);
+	for (size_t i = 0; i < count; i++, rec += TOKBIN_RECORD) {
+		Token add = {0};
+		size_t offset = _tokbin_get32(rec);
+		size_t tlen = _tokbin_get32(rec + 4);
+		add.line = _tokbin_get32(rec + 8);
+		add.col = _tokbin_get32(rec + 12);
+		add.type = _tokbin_get32(rec + 16);
+
+		if (offset + tlen >= str_size || strings[offset + tlen] != 0 || add.type < 0 || add.type > TT_SPLITTR) {
+			tok_stream_end(out);
+			return false;
+		}
+
+		add.data = strings + offset;
+		add.len = strnlen(add.data, tlen);
+		add.sym = sym_intern_n(add.data, add.len);
+		tok_decode_literal(&add);
+		vect_push(out, &add);
+	}
+
+	return true;
+}
+
+// Tokens of a file which holds either source text or a binary token
+// stream.  Returns false if a binary stream is malformed.
+bool tok_load(char *src, size_t len, Vector *out) {
+	if (tok_is_binary(src, len))
+		return tok_read_binary(src, len, out);
+	*out = parse_file(src, len);
+	return true;
+}
+
+
+
+// Abstract syntax tree - the block and statement structure of a file,
+// built once at the end of phase 1 (see ast_build) and walked by phase 2.
+// Token positions are indices into the file's tokens, expressions are
+// still token ranges.  Nodes are kept in mod_arena.
+
+#define AST_COMPTIME 0  // Bad comptime declaration, tok: token after the ':'
+#define AST_ASM 1       // tok: token after 'asm'
+#define AST_FDEF 2      // Module level definition, children: AST_NAME/AST_BAD_NAME and AST_EXPR values
+#define AST_FUNCTION 3  // tok: opener, start: name, end: last token read (for errors), children: statements
+#define AST_MODULE 4    // tok: opener, start: name, children: module items
+#define AST_METHOD 5    // tok: opener, start: type name, children: AST_FUNCTION
+#define AST_BLOCK 6     // Any other block, tok: opener, sub: block type, at: see tnsl_block_kind
+#define AST_WRAP 7      // if/else chain, children: AST_CONTROL, at: else found first (-1 for none)
+#define AST_CONTROL 8   // sub: CTRL_*, pre/post: statements in the () and [] sections, children: statements
+#define AST_DEF 9       // Local definition, type: the parsed type, children: AST_NAME/AST_BAD_NAME and AST_EXPR
+#define AST_NAME 10     // tok: name of a variable being defined
+#define AST_BAD_NAME 11 // tok: token found where a variable name was expected
+#define AST_RETURN 12   // tok: 'return', sub: has a value (start, end)
+#define AST_KEYWORD 13  // Keyword which is not supported as a statement, tok: the keyword
+#define AST_EXPR 14     // Expression (start, end).  In a control section sub is set if it
+                        // ends the section, a loop condition is then tok to end
+
+// Control block types (also index CTRL_NAMES)
+#define CTRL_BAD -1  // at: the token which should have been the type
+#define CTRL_LOOP 0
+#define CTRL_IF 1
+#define CTRL_ELSE 2
+#define CTRL_ELIF 3
+
+char *CTRL_NAMES[] = {"loop", "if", "else", "elif"};
+
+typedef struct {
+	int kind;
+	int sub;              // Kind specific value, for the module level kinds
+	                      // which have a name it is set if the name was bad
+	size_t tok;
+	size_t start, end;
+	int at;
+	Vector children;      // Node, empty (not initialized) for leaves
+	Vector pre, post;     // Node, AST_CONTROL only
+	Variable type;        // AST_DEF only
+	Artifact ptrs;        // AST_FUNCTION only, names which have their address taken
+} Node;
+
+
+// Source file cache - every file taking part in a compile is tokenized
+// once and the token stream is shared between both phases.
+
+// Import graph states for a file
+#define SRC_UNSEEN 0 // Tokenized but not yet cataloged
+#define SRC_OPEN 1   // Being cataloged (still walking the file's imports)
+#define SRC_DONE 2   // Cataloged
+
+typedef struct SrcFile {
+	char *path;      // Canonical path to the file
+	char *src;       // Contents of the file, tokens point into this
+	Vector tokens;   // Tokenization of the file
+	int bad_delims;  // Number of unmatched delimiters in the tokens
+	Vector imports;  // Files imported by this file (SrcFile *)
+	char *module;    // Full path of the module the file was imported into
+	int state;       // Import graph state
+	bool ordered;    // Already placed in the compile order
+	Vector ast;      // Top level nodes of the file (Node), see ast_build
+} SrcFile;
+
+// Frees the file's path, source, tokens, and import list
+void src_end(SrcFile *f) {
+	free(f->path);
+	free(f->module);
+	free(f->src);
+	vect_end(&f->imports);
+	tok_stream_end(&f->tokens);
+}
+
+// Returns the cached file for the given path, tokenizing it if it has not
+// been seen yet this compile.  Returns NULL if the file can not be read.
+SrcFile *src_cache_get(Vector *cache, Artifact *path) {
+	char *full_path = art_to_str(path, '/');
+	char *canon = realpath(full_path, NULL);
+
+	if (canon == NULL) {
+		printf("Unable to open file %s for reading.\n\n", full_path);
+		return NULL;
+	}
+
+	for (size_t i = 0; i < cache->count; i++) {
+		SrcFile **f = vect_get(cache, i);
+		if (strcmp((*f)->path, canon) == 0) {
+			free(canon);
+			return *f;
 		}
 	}
 
+	FILE *fin = fopen(canon, "r");
+
+	if (fin == NULL) {
+		printf("Unable to open file %s for reading.\n\n", full_path);
+		free(canon);
+		return NULL;
+	}
+
+	// Stored by pointer so references stay valid as the cache grows
+	SrcFile *out = malloc(sizeof(SrcFile));
+	size_t len;
+	out->path = canon;
+	out->src = read_file(fin, &len);
+	fclose(fin);
+
+	if (!tok_load(out->src, len, &out->tokens)) {
+		printf("Malformed token stream in file %s.\n\n", full_path);
+		free(out->path);
+		free(out->src);
+		free(out);
+		return NULL;
+	}
+
+	out->bad_delims = tok_match_delims(&out->tokens);
+	out->imports = vect_init(sizeof(SrcFile *));
+	out->module = NULL;
+	out->state = SRC_UNSEEN;
+	out->ordered = false;
+	out->ast = vect_init_in(&mod_arena, sizeof(Node));
+
+	vect_push(cache, &out);
+	return out;
+}
+
+void _src_order_rec(SrcFile *f, Vector *order) {
+	if (f->ordered)
+		return;
+	f->ordered = true;
+
+	for (size_t i = 0; i < f->imports.count; i++) {
+		SrcFile **dep = vect_get(&f->imports, i);
+		_src_order_rec(*dep, order);
+	}
+
+	vect_push(order, &f);
+}
+
+// Topological order of the import graph starting at the given file.
+// Every reachable file appears once, after all the files it imports.
+Vector src_compile_order(SrcFile *first) {
+	Vector out = vect_init(sizeof(SrcFile *));
+	_src_order_rec(first, &out);
 	return out;
 }
 
+// Frees all files in the cache, then calls vect_end
+void src_cache_end(Vector *cache) {
+	for (size_t i = 0; i < cache->count; i++) {
+		SrcFile **f = vect_get(cache, i);
+		src_end(*f);
+		free(*f);
+	}
+	vect_end(cache);
+}
+
 
 
 // Compiler funcs
@@ -2801,10 +4079,10 @@ Vector parse_file(FILE *fin) {
 #define BT_ENUM 6
 #define BT_LAMBDA 7
 
-unsigned long tnsl_parse_binary(char *data) {
+unsigned long tnsl_parse_binary(char *data, int len) {
 	unsigned long out = 0;
 	
-	for(size_t i = 2; data[i] != 0; i++) {
+	for(size_t i = 2; i < len; i++) {
 		if (data[i] != '0' && data[i] != '1') {
 			return out;
 		}
@@ -2818,10 +4096,10 @@ unsigned long tnsl_parse_binary(char *data) {
 	return out;
 }
 
-unsigned long tnsl_parse_octal(char *data) {
+unsigned long tnsl_parse_octal(char *data, int len) {
 	unsigned long out = 0;
 	
-	for(size_t i = 2; data[i] != 0; i++) {
+	for(size_t i = 2; i < len; i++) {
 		if (data[i] < '0' || data[i] > '7') {
 			return out;
 		}
@@ -2833,10 +4111,10 @@ unsigned long tnsl_parse_octal(char *data) {
 	return out;
 }
 
-unsigned long tnsl_parse_decimal(char *data) {
+unsigned long tnsl_parse_decimal(char *data, int len) {
 	unsigned long out = 0;
 
-	for(size_t i = 0; data[i] != 0; i++) {
+	for(size_t i = 0; i < len; i++) {
 		if (data[i] < '0' || data[i] > '9')
 			return out;
 
@@ -2847,10 +4125,10 @@ unsigned long tnsl_parse_decimal(char *data) {
 	return out;
 }
 
-unsigned long tnsl_parse_hex(char *data) {
+unsigned long tnsl_parse_hex(char *data, int len) {
 	unsigned long out = 0;
 
-	for(size_t i = 2; data[i] != 0; i++) {
+	for(size_t i = 2; i < len; i++) {
 		char tmp = data[i];
 
 		if (tmp >= 'a') {
@@ -2873,25 +4151,25 @@ unsigned long tnsl_parse_hex(char *data) {
 }
 
 unsigned long tnsl_parse_number (Token *numeric_literal) {
-	int l = strlen(numeric_literal->data);
+	int l = numeric_literal->len;
 
 	if (l > 2 && numeric_literal->data[0] == '0' && numeric_literal->data[1] > '9') {
 		switch (numeric_literal->data[1]) {
 			case 'B':
 			case 'b':
-				return tnsl_parse_binary(numeric_literal->data);
+				return tnsl_parse_binary(numeric_literal->data, l);
 			case 'O':
 			case 'o':
-				return tnsl_parse_octal(numeric_literal->data);
+				return tnsl_parse_octal(numeric_literal->data, l);
 			case 'X':
 			case 'x':
-				return tnsl_parse_hex(numeric_literal->data);
+				return tnsl_parse_hex(numeric_literal->data, l);
 			default:
 				printf("ERROR: Unknown prefix for number (0%c) at %d:%d\n\n", numeric_literal->data[1], numeric_literal->line, numeric_literal->col);
 				return 0;
 		}
 	}
-	return tnsl_parse_decimal(numeric_literal->data);
+	return tnsl_parse_decimal(numeric_literal->data, l);
 }
 
 Token *tnsl_find_last_token(Vector *tokens, size_t pos) {
@@ -2919,10 +4197,10 @@ int tnsl_next_non_nl(Vector *tokens, size_t pos) {
 // ptr_chain = full pointer chain of the type
 Variable tnsl_parse_type(Vector *tokens, size_t cur) {
 	Vector ftn = vect_init(sizeof(char));
-	Vector ptr = vect_init(sizeof(int));
+	PtrChain ptr = ptrc_init(var_arena);
 	
 	Variable err = {0};
-	err.name = NULL;
+	err.name = SYM_NONE;
 	err.location = LOC_LITL;
 	err.offset = 0;
 	err.type = NULL;
@@ -2934,17 +4212,17 @@ Variable tnsl_parse_type(Vector *tokens, size_t cur) {
 		Token *t = vect_get(tokens, cur);
 		if (t == NULL) {
 			vect_end(&ftn);
-			vect_end(&ptr);
+			ptrc_end(&ptr);
 			return err;
 		} else if (t->type == TT_KEYTYPE || t->type == TT_DEFWORD) {
 			break;
 		} else if (t->type == TT_AUGMENT) {
 			if (tok_str_eq(t, "~")) {
 				add = PTYPE_PTR;
-				vect_push(&ptr, &add);
+				ptrc_push(&ptr, add);
 			} else {
 				vect_end(&ftn);
-				vect_end(&ptr);
+				ptrc_end(&ptr);
 				return err;
 			}
 		} else if (t->type == TT_DELIMIT) {
@@ -2956,25 +4234,25 @@ Variable tnsl_parse_type(Vector *tokens, size_t cur) {
 				} else if (t->type == TT_LITERAL && t->data[0] >= '0' && t->data[0] <= '9') {
 					// This functionality is not well implemented yet, but it is supposed to
 					// represent a fixed-size array
-					add = tnsl_parse_number(t);
-					vect_push(&ptr, &add);
+					add = t->value;
+					ptrc_push(&ptr, add);
 					cur++;
 					t = vect_get(tokens, cur);
 					if (t->type != TT_DELIMIT || !tok_str_eq(t, "}")) {
 						vect_end(&ftn);
-						vect_end(&ptr);
+						ptrc_end(&ptr);
 						return err;
 					}
 				}
-				vect_push(&ptr, &add);
+				ptrc_push(&ptr, add);
 			} else {
 				vect_end(&ftn);
-				vect_end(&ptr);
+				ptrc_end(&ptr);
 				return err;
 			}
 		} else {
 			vect_end(&ftn);
-			vect_end(&ptr);
+			ptrc_end(&ptr);
 			return err;
 		}
 	}
@@ -2985,20 +4263,20 @@ Variable tnsl_parse_type(Vector *tokens, size_t cur) {
 	Token *t = vect_get(tokens, cur);
 	if(t == NULL) {
 		vect_end(&ftn);
-		vect_end(&ptr);
+		ptrc_end(&ptr);
 		return err;
 	} else if (t->type == TT_KEYTYPE) {
-		vect_push_string(&ftn, t->data);
+		vect_push_nstring(&ftn, t->data, t->len);
 		cur++;
 	} else if (t->type == TT_DEFWORD) {
 		for(; cur < tokens->count; cur++) {
 			t = vect_get(tokens, cur);
 
 			if (t != NULL && t->type == TT_DEFWORD) {
-				vect_push_string(&ftn, t->data);	
+				vect_push_nstring(&ftn, t->data, t->len);	
 			} else {
 				vect_end(&ftn);
-				vect_end(&ptr);
+				ptrc_end(&ptr);
 				return err;
 			}
 
@@ -3006,7 +4284,7 @@ Variable tnsl_parse_type(Vector *tokens, size_t cur) {
 			t = vect_get(tokens, cur);
 
 			if (t != NULL && t->type == TT_AUGMENT && tok_str_eq(t, ".")) { 
-				vect_push_string(&ftn, t->data);
+				vect_push_nstring(&ftn, t->data, t->len);
 			} else {
 				break;
 			}
@@ -3016,13 +4294,13 @@ Variable tnsl_parse_type(Vector *tokens, size_t cur) {
 	t = vect_get(tokens, cur);
 	if (t != NULL && tok_str_eq(t, "`")) {
 		add = PTYPE_REF;
-		vect_push(&ptr, &add);
+		ptrc_push(&ptr, add);
 		cur++;
 	}
 
 	Variable out = {0};
 	
-	out.name = vect_as_string(&ftn);
+	out.name = sym_intern_free(vect_as_string(&ftn));
 	out.type = NULL;
 	out.location = cur;
 	out.ptr_chain = ptr;
@@ -3033,12 +4311,11 @@ Variable tnsl_parse_type(Vector *tokens, size_t cur) {
 bool tnsl_is_def(Vector *tokens, size_t cur) {
 	Variable to_free = tnsl_parse_type(tokens, cur);
 	
-	if (to_free.name == NULL) {
+	if (to_free.name == SYM_NONE) {
 		return false;
 	}
 
-	free(to_free.name);
-	vect_end(&(to_free.ptr_chain));
+	ptrc_end(&(to_free.ptr_chain));
 
 	Token *next = vect_get(tokens, to_free.location);
 	if (next != NULL && next->type == TT_DEFWORD) {
@@ -3051,75 +4328,18 @@ bool tnsl_is_boolean() {
 	return false;
 }
 
+// Index of the delimiter closing the one at cur, or -1 if cur is not an
+// opening delimiter or was never closed.  Matches are found once per file
+// by tok_match_delims.
 int tnsl_find_closing(Vector *tokens, size_t cur) {
-	char closing = 0;
-
 	Token *first = vect_get(tokens, cur);
-	Token *check;
-
-	if (tok_str_eq(first, "(")) {
-		closing = ')';
-	} else if (tok_str_eq(first, "[")) {
-		closing = ']';
-	} else if (tok_str_eq(first, "{")) {
-		closing = '}';
-	} else if (tok_str_eq(first, "/;") || tok_str_eq(first, ";;")) {
-		closing = ';';
-	} else {
+	if (first == NULL || first->match < 0 || (size_t)first->match < cur)
 		return -1;
-	}
-
-	cur += 1;
-	int paren = 0, brak = 0, squig = 0, block = 0;
-
-	for(; cur < tokens->count; cur++) {
-		check = vect_get(tokens, cur);
-		if (check->type == TT_DELIMIT) {
-			if (check->data[0] == closing && paren == 0 && brak == 0 && squig == 0 && block == 0) {
-				return cur;
-			}
-
-			switch (check->data[0]) {
-			case '(':
-				paren += 1;
-				break;
-			case '[':
-				brak += 1;
-				break;
-			case '{':
-				squig += 1;
-				break;
-			case ')':
-				paren -= 1;
-				break;
-			case ']':
-				brak -= 1;
-				break;
-			case '}':
-				squig -= 1;
-				break;
-			}
-
-			if (tok_str_eq(check, "/;"))
-				block += 1;
-			else if (tok_str_eq(check, ";/"))
-				block -= 1;
-
-			if (paren < 0 || brak < 0 || squig < 0 || block < 0) {
-				printf("Unmatched closing delimiter at {line %d, col %d, \"%s\"}\n", check->line, check->col, check->data);
-				printf("Looking for closing delimiter for {line %d, col %d, \"%s\"}\n\n", first->line, first->col, first->data);
-				return -1;
-			}
-		}
-	}
-
-	printf("Could not find closing for delimiter (line %d, col %d, \"%s\")\n\n", first->line, first->col, first->data);
-
-	return -1;
+	return first->match;
 }
 
-Vector tnsl_find_all_pointers(Vector *tokens, size_t start, size_t end) {
-	Vector out = vect_init(sizeof(char*));
+Artifact tnsl_find_all_pointers(Vector *tokens, size_t start, size_t end, Arena *a) {
+	Artifact out = art_init_in(a);
 	
 	for(start++;start < end; start++) {
 		Token *cur = vect_get(tokens, start);
@@ -3127,9 +4347,7 @@ Vector tnsl_find_all_pointers(Vector *tokens, size_t start, size_t end) {
 			start++;
 			cur = vect_get(tokens, start);
 			if(cur->type == TT_DEFWORD) {
-				Vector data = vect_from_string(cur->data);
-				char *str = vect_as_string(&data);
-				vect_push(&out, &str);
+				art_add_sym(&out, cur->sym);
 			}
 		}
 	}
@@ -3163,8 +4381,7 @@ char tnsl_unquote_char(char *str) {
 	return str[0];
 }
 
-Vector tnsl_unquote_str(char *literal) {
-	int len = strlen(literal);
+Vector tnsl_unquote_str(char *literal, int len) {
 	Vector str_out = vect_init(sizeof(char));
 	if (len < 2)
 		return str_out;
@@ -3184,8 +4401,12 @@ Vector tnsl_unquote_str(char *literal) {
 	return str_out;
 }
 
-int tnsl_block_type(Vector *tokens, size_t cur) {
-	
+// Type of the block opened at cur.  at is set to the keyword which decided
+// the type, or -1 if there was none.  Nothing is printed, problems with
+// the block are reported by tnsl_block_report.
+int tnsl_block_kind(Vector *tokens, size_t cur, int *at) {
+	*at = -1;
+
 	for (cur++; cur < tokens->count; cur++) {
 		Token *t = vect_get(tokens, cur);
 		
@@ -3194,6 +4415,7 @@ int tnsl_block_type(Vector *tokens, size_t cur) {
 		} else if (t->type == TT_DEFWORD) {
 			return BT_FUNCTION;
 		} else if (t->type == TT_KEYWORD) {
+			*at = cur;
 			if (tok_str_eq(t, "loop") || tok_str_eq(t, "if") || tok_str_eq(t, "else")) {
 				return BT_CONTROL;
 			} else if (tok_str_eq(t, "export") || tok_str_eq(t, "module")) {
@@ -3203,13 +4425,10 @@ int tnsl_block_type(Vector *tokens, size_t cur) {
 			} else if (tok_str_eq(t, "enum")) {
 				return BT_ENUM;
 			} else if (tok_str_eq(t, "operator")) {
-				printf("WARNING: Operator block not implemented (Found at %d:%d)\n\n", t->line, t->col);
 				return BT_OPERATOR;
 			} else if (tok_str_eq(t, "interface")) {
-				printf("WARNING: Interface block not implemented (Found at %d:%d)\n\n", t->line, t->col);
 				return BT_INTERFACE;
 			} else {
-				printf("ERROR: Invalid keyword when parsing block (%s at %d:%d)\n\n", t->data, t->line, t->col);
 				return -1;
 			}
 		} else if (t->type == TT_DELIMIT) {
@@ -3223,107 +4442,611 @@ int tnsl_block_type(Vector *tokens, size_t cur) {
 	return -1;
 }
 
-
-// Phase 1 - Module building
-bool p1_error = false;
-
-void p1_parse_params(Vector *var_list, Vector *tokens, size_t *pos) {
-	int end = tnsl_find_closing(tokens, *pos);
-	Token *t = vect_get(tokens, *pos);
-
-	if (end < 0) {
-		printf("ERROR: Could not find closing when parsing parameter list \"%s\" (%d:%d)\n", t->data, t->line, t->col);
-		p1_error = true;
+void tnsl_block_report(Vector *tokens, int type, int at) {
+	if (at < 0)
 		return;
+
+	Token *t = vect_get(tokens, at);
+	if (type == BT_OPERATOR) {
+		printf("WARNING: Operator block not implemented (Found at %d:%d)\n\n", t->line, t->col);
+	} else if (type == BT_INTERFACE) {
+		printf("WARNING: Interface block not implemented (Found at %d:%d)\n\n", t->line, t->col);
+	} else if (type < 0) {
+		printf("ERROR: Invalid keyword when parsing block (%.*s at %d:%d)\n\n", t->len, t->data, t->line, t->col);
 	}
-	
-	Variable current_type = {0};
-	current_type.name = NULL;
-	current_type.type = NULL;
+}
 
-	for(*pos = tnsl_next_non_nl(tokens, *pos); *pos < (size_t) end; *pos = tnsl_next_non_nl(tokens, *pos)) {
-		size_t next = tnsl_next_non_nl(tokens, *pos);
-		t = vect_get(tokens, tnsl_next_non_nl(tokens, *pos));
+int tnsl_block_type(Vector *tokens, size_t cur) {
+	int at;
+	int type = tnsl_block_kind(tokens, cur, &at);
+	tnsl_block_report(tokens, type, at);
+	return type;
+}
 
-		if(!tok_str_eq(t, ",") && next < (size_t) end) {
-			if(current_type.name != NULL) {
-				free(current_type.name);
-				vect_end(&(current_type.ptr_chain));
-			}
-			current_type = tnsl_parse_type(tokens, *pos);
-			
-			if (current_type.location > 0)
-				*pos = tnsl_next_non_nl(tokens, current_type.location - 1);
-		}
 
-		t = vect_get(tokens, *pos);
-		
-		if (current_type.name == NULL) {
-			printf("ERROR: Expected a valid type.\n");
-			printf("       \"%s\" line %d column %d\n\n", t->data, t->line, t->col);
-			p1_error = true;
-			break;
-		} else if (t->type != TT_DEFWORD) {
-			printf("ERROR: Unexpected token in member/parameter list (was looking for a user defined name)\n");
-			printf("       \"%s\" line %d column %d\n\n", t->data, t->line, t->col);
-			p1_error = true;
-			break;
-		}
+// AST building.  Each builder walks the tokens the same way phase 2 used
+// to, so statements start and end where they always have, even in
+// malformed blocks.  Nothing is printed here, phase 2 reports problems
+// when it reaches the node.
 
-		// The name of the variable is "<User defined name> <Dot deliniated type string>"
-		// this is specifically so that types may be defined out of order, and will be
-		// cleaned up when p1_size_structs is called.
-		Variable member = var_copy(&current_type);
-		member.location = -1;
-		Vector name_type = vect_from_string(t->data);
-		vect_push_string(&name_type, " ");
-		vect_push_string(&name_type, member.name);
-		free(member.name);
-		member.name = vect_as_string(&name_type);
+Node ast_node(int kind, size_t tok) {
+	Node out = {0};
+	out.kind = kind;
+	out.tok = tok;
+	out.at = -1;
+	return out;
+}
 
-		// Add the member to the struct (the member's type will be resolved later)
-		vect_push(var_list, &member);
+void ast_push(Vector *nodes, Node *n) {
+	if (nodes->_el_sz == 0)
+		*nodes = vect_init_in(&mod_arena, sizeof(Node));
+	vect_push(nodes, n);
+}
 
-		*pos = tnsl_next_non_nl(tokens, *pos);
-		t = vect_get(tokens, *pos);
+void _ast_push_leaf(Vector *nodes, int kind, size_t tok) {
+	Node n = ast_node(kind, tok);
+	ast_push(nodes, &n);
+}
 
-		if (*pos >= (size_t)end) {
+void _ast_push_range(Vector *nodes, size_t start, size_t end) {
+	Node n = ast_node(AST_EXPR, start);
+	n.start = start;
+	n.end = end;
+	ast_push(nodes, &n);
+}
+
+// Expression statement starting at *pos.  It ends at the first splitter or
+// closing delimiter outside of any delimiters, where *pos is left.
+Node ast_expr(Vector *tokens, size_t *pos) {
+	size_t end = *pos;
+	for (; end < tokens->count; end++) {
+		Token *chk = vect_get(tokens, end);
+		if(chk->type == TT_SPLITTR) {
 			break;
-		} else if (tok_str_eq(t, ",") != true) {
-			printf("ERROR: Unexpected token in member list (was looking for a comma to separate members)\n");
-			printf("       \"%s\" line %d column %d\n\n", t->data, t->line, t->col);
-			p1_error = true;
+		} else if (chk->type == TT_DELIMIT) {
+			int i = tnsl_find_closing(tokens, end);
+			if(i > 0) {
+				end = i;
+				continue;
+			}
 			break;
 		}
 	}
-	
-	if (current_type.name != NULL) {
-		free(current_type.name);
-		vect_end(&(current_type.ptr_chain));
-	}
 
+	Node out = ast_node(AST_EXPR, *pos);
+	out.start = *pos;
+	out.end = end;
 	*pos = end;
+	return out;
 }
 
-void p1_parse_type_list(Vector *var_list, Vector *tokens, size_t *pos) {
-	int end = tnsl_find_closing(tokens, *pos);
-	Token *t = vect_get(tokens, *pos);
-
-	if (end < 0) {
-		printf("ERROR: Could not find closing when parsing parameter list \"%s\" (%d:%d)\n", t->data, t->line, t->col);
-		p1_error = true;
-		return;
-	}
+// Module level definition, *pos is left at the end of the line
+Node ast_fdef(Vector *tokens, size_t *pos) {
+	Node out = ast_node(AST_FDEF, *pos);
 
-	for(*pos += 1; *pos < (size_t) end;) {
-		Variable to_add = tnsl_parse_type(tokens, *pos);
+	Variable type = tnsl_parse_type(tokens, *pos);
+	*pos = type.location;
+	var_end(&type);
 
-		if(to_add.location < 0) {
-			t = vect_get(tokens, *pos);
-			printf("ERROR: Could not parse type when in type list ~(%d:%d)\n", t->line, t->col);
-			p1_error = true;
-			break;
-		}
+	size_t start = *pos;
+	while (*pos < tokens->count && !tok_str_eq(vect_get(tokens, *pos), "\n")) {
+		Token *t = vect_get(tokens, *pos);
+
+		if (start == *pos) {
+			if (t->type != TT_DEFWORD) {
+				_ast_push_leaf(&out.children, AST_BAD_NAME, *pos);
+				return out;
+			}
+			_ast_push_leaf(&out.children, AST_NAME, *pos);
+		} else if (t->type == TT_DELIMIT) {
+			*pos = tnsl_find_closing(tokens, *pos);
+		} else if (tok_str_eq(t, ",")) {
+			_ast_push_range(&out.children, start, *pos);
+			start = *pos + 1;
+		}
+
+		*pos += 1;
+	}
+
+	_ast_push_range(&out.children, start, *pos);
+	return out;
+}
+
+// Definition inside a function, *pos is left at the end of the statement
+Node ast_def(Vector *tokens, size_t *pos) {
+	Node out = ast_node(AST_DEF, *pos);
+
+	out.type = tnsl_parse_type(tokens, *pos);
+	*pos = out.type.location;
+
+	size_t start = *pos;
+	while (*pos < tokens->count) {
+		Token *t = vect_get(tokens, *pos);
+		
+		if (start == *pos) {
+			if (t->type != TT_DEFWORD) {
+				_ast_push_leaf(&out.children, AST_BAD_NAME, *pos);
+				return out;
+			}
+			_ast_push_leaf(&out.children, AST_NAME, *pos);
+		} else if (t->type == TT_DELIMIT) {
+			*pos = tnsl_find_closing(tokens, *pos);
+		} else if (tok_str_eq(t, ",")) {
+			// Split def
+			if(*pos - start > 1)
+				_ast_push_range(&out.children, start, *pos);
+			start = *pos + 1;
+		} else if (tok_str_eq(t, ";") || tok_str_eq(t, "\n")) {
+			break;
+		}
+		*pos += 1;
+	}
+
+	if (*pos - start > 1)
+		_ast_push_range(&out.children, start, *pos);
+	return out;
+}
+
+// Statements in the () or [] section of a control block, opened at open
+void ast_section(Vector *out, Vector *tokens, int open, char *close) {
+	size_t start = tnsl_next_non_nl(tokens, open);
+	int s_end = tnsl_find_closing(tokens, open);
+	int cur = start;
+
+	for (;start <= cur && cur <= s_end; cur = tnsl_next_non_nl(tokens, cur)) {
+		if (cur == start && tnsl_is_def(tokens, start)) {
+			Node def = ast_def(tokens, &start);
+			ast_push(out, &def);
+			cur = start;
+		}
+
+		Token *t = vect_get(tokens, cur);
+		if (tok_str_eq(t, ";") || tok_str_eq(t, close)) {
+			if (cur != start) {
+				Node n = ast_node(AST_EXPR, start);
+				n.start = start;
+				n.end = cur;
+				if (tok_str_eq(t, close)) {
+					n.sub = 1;
+					n.tok = tnsl_next_non_nl(tokens, start - 1);
+				}
+				ast_push(out, &n);
+			}
+			start = cur + 1;
+		} else if (t->type == TT_DELIMIT) {
+			cur = tnsl_find_closing(tokens, cur);
+		}
+	}
+}
+
+Node ast_control(Vector *tokens, size_t *pos, bool in_wrap);
+
+// Statements of a function or control block up to end.  last is set to
+// the last statement's first token (or its asm string).
+void ast_body(Vector *out, Vector *tokens, size_t *pos, size_t end, size_t *last, bool func) {
+	for (; *pos < end; *pos = tnsl_next_non_nl(tokens, *pos)) {
+		Token *t = vect_get(tokens, *pos);
+		*last = *pos;
+
+		if (tok_str_eq(t, "/;") || tok_str_eq(t, ";;")) {
+			size_t b_open = *pos;
+			int at;
+			int type = tnsl_block_kind(tokens, *pos, &at);
+			Node n;
+
+			if (type == BT_CONTROL) {
+				n = ast_control(tokens, pos, false);
+			} else {
+				n = ast_node(AST_BLOCK, *pos);
+				n.sub = type;
+				n.at = at;
+				if (!func)
+					*pos = end - 1;
+			}
+			ast_push(out, &n);
+
+			if (*pos == b_open) {
+				*pos = tnsl_find_closing(tokens, b_open);
+			} else if (tok_str_eq(t, ";;")) {
+				*pos -= 1;
+			}
+		} else if (t->type == TT_KEYWORD) {
+			if (tok_str_eq(t, "return")) {
+				Node n = ast_node(AST_RETURN, *pos);
+				t = vect_get(tokens, *pos + 1);
+				if (*pos + 1 < end && !tok_str_eq(t, "\n")) {
+					size_t value = *pos + 1;
+					Node e = ast_expr(tokens, &value);
+					n.sub = 1;
+					n.start = e.start;
+					n.end = e.end;
+				}
+				ast_push(out, &n);
+
+				// Nothing after a return is compiled
+				*pos = end;
+				if (func)
+					return;
+			} else if (tok_str_eq(t, "asm")) {
+				*last = ++(*pos);
+				_ast_push_leaf(out, AST_ASM, *pos);
+			} else {
+				_ast_push_leaf(out, AST_KEYWORD, *pos);
+			}
+		} else if (tnsl_is_def(tokens, *pos)) {
+			Node n = ast_def(tokens, pos);
+			ast_push(out, &n);
+		} else {
+			Node n = ast_expr(tokens, pos);
+			ast_push(out, &n);
+		}
+	}
+}
+
+// Chain of if/else blocks starting at *pos
+Node ast_wrap(Vector *tokens, size_t *pos) {
+	Node out = ast_node(AST_WRAP, *pos);
+
+	bool first = true;
+	for (;*pos < tokens->count;) {
+		int end = tnsl_find_closing(tokens, *pos);
+		Token *cur = vect_get(tokens, *pos);
+		if (end < 0 || (!tok_str_eq(cur, "/;") && !tok_str_eq(cur, ";;"))) {
+			break;
+		}
+
+		cur = vect_get(tokens, *pos + 1);
+		
+		if (tok_str_eq(cur, "if") && first) {
+			Node n = ast_control(tokens, pos, true);
+			ast_push(&out.children, &n);
+			first = false;
+		} else if (tok_str_eq(cur, "else") && !first) {
+			Node n = ast_control(tokens, pos, true);
+			ast_push(&out.children, &n);
+		} else {
+			if (tok_str_eq(cur, "else") && first)
+				out.at = *pos + 1;
+			break;
+		}
+		
+		*pos = end;
+	}
+
+	return out;
+}
+
+// Control block opened at *pos.  if and else blocks which are not already
+// part of a chain are wrapped in one (see ast_wrap).
+Node ast_control(Vector *tokens, size_t *pos, bool in_wrap) {
+	int end = tnsl_find_closing(tokens, *pos);
+	Node out = ast_node(AST_CONTROL, *pos);
+
+	*pos += 1;
+	Token *t = vect_get(tokens, *pos);
+
+	if (tok_str_eq(t, "if") || tok_str_eq(t, "else")) {
+		if (!in_wrap) {
+			*pos -= 1;
+			return ast_wrap(tokens, pos);
+		}
+
+		t = vect_get(tokens, *pos + 1);
+		if (tok_str_eq(t, "if")) {
+			*pos += 1;
+			out.sub = CTRL_ELIF;
+		} else {
+			t = vect_get(tokens, *pos);
+			out.sub = tok_str_eq(t, "if") ? CTRL_IF : CTRL_ELSE;
+		}
+	} else if (t->type != TT_KEYWORD || !tok_str_eq(t, "loop")) {
+		out.sub = CTRL_BAD;
+		out.at = *pos;
+		*pos = end;
+		return out;
+	} else {
+		out.sub = CTRL_LOOP;
+	}
+
+	// Find pre and post control statements
+	int build = -1;
+	int rep = -1;
+	for (*pos += 1; *pos < (size_t)end; *pos += 1) {
+		t = vect_get(tokens, *pos);
+		
+		if (tok_str_eq(t, "(")) {
+			build = *pos;
+			*pos = tnsl_find_closing(tokens, *pos);
+		} else if (tok_str_eq(t, "[")) {
+			rep = *pos;
+			*pos = tnsl_find_closing(tokens, *pos);
+		} else {
+			break;
+		}
+	}
+
+	if (build > -1)
+		ast_section(&out.pre, tokens, build, ")");
+
+	size_t last;
+	*pos = tnsl_next_non_nl(tokens, *pos - 1);
+	ast_body(&out.children, tokens, pos, end, &last, false);
+
+	if (rep > -1)
+		ast_section(&out.post, tokens, rep, "]");
+
+	return out;
+}
+
+Node ast_function(Vector *tokens, size_t *pos) {
+	Node out = ast_node(AST_FUNCTION, *pos);
+	int end = tnsl_find_closing(tokens, *pos);
+
+	out.ptrs = tnsl_find_all_pointers(tokens, *pos, end, &mod_arena);
+
+	Token *t = vect_get(tokens, *pos);
+	while (t != NULL && *pos < (size_t)end && t->type != TT_DEFWORD) {
+		t = vect_get(tokens, ++(*pos));
+		if(tok_str_eq(t, "\n"))
+			break;
+		else if (t->type == TT_DELIMIT && !tok_str_eq(t, ";/") && !tok_str_eq(t, ";;")) {
+			*pos = tnsl_find_closing(tokens, *pos);
+		}
+	}
+
+	if(t == NULL || t->type != TT_DEFWORD) {
+		out.sub = 1;
+		return out;
+	}
+	out.start = *pos;
+
+	// Skip the rest of the signature
+	size_t last = *pos;
+	while(*pos < (size_t)end) {
+		t = vect_get(tokens, *pos);
+		last = *pos;
+		if(tok_str_eq(t, "\n"))
+			break;
+		else if (t->type == TT_DELIMIT)
+			*pos = tnsl_find_closing(tokens, *pos);
+		*pos += 1;
+	}
+
+	*pos = tnsl_next_non_nl(tokens, *pos);
+	ast_body(&out.children, tokens, pos, end, &last, true);
+
+	out.end = last;
+	*pos = end;
+	return out;
+}
+
+Node ast_method(Vector *tokens, size_t *pos) {
+	int end = tnsl_find_closing(tokens, *pos);
+	Node out = ast_node(AST_METHOD, *pos);
+
+	*pos += 2;
+	Token *t = vect_get(tokens, *pos);
+	out.start = *pos;
+
+	if (t == NULL || t->type != TT_DEFWORD) {
+		out.sub = 1;
+		*pos = end;
+		return out;
+	}
+
+	for(;*pos < (size_t)end;*pos = tnsl_next_non_nl(tokens, *pos)) {
+		t = vect_get(tokens, *pos);
+		if(tok_str_eq(t, "/;") != true && tok_str_eq(t, ";;") != true) {
+			continue;
+		}
+
+		Node f = ast_function(tokens, pos);
+		ast_push(&out.children, &f);
+		
+		t = vect_get(tokens, *pos);
+		if(tok_str_eq(t, ";;")) {
+			*pos -= 1;
+		}
+	}
+	
+	*pos = end;
+	return out;
+}
+
+void ast_file_loop(Vector *out, Vector *tokens, size_t start, size_t end);
+
+Node ast_module(Vector *tokens, size_t *pos) {
+	int end = tnsl_find_closing(tokens, *pos);
+	Node out = ast_node(AST_MODULE, *pos);
+
+	*pos += 1;
+	Token *t = vect_get(tokens, *pos);
+
+	if(tok_str_eq(t, "export")){
+		*pos += 1;
+	}
+
+	*pos += 1;
+	t = vect_get(tokens, *pos);
+	out.start = *pos;
+
+	if (t == NULL || t->type != TT_DEFWORD) {
+		out.sub = 1;
+		*pos = end;
+		return out;
+	}
+
+	ast_file_loop(&out.children, tokens, *pos, end);
+
+	*pos = end;
+	return out;
+}
+
+// Items of a file or module body between start and end
+void ast_file_loop(Vector *out, Vector *tokens, size_t start, size_t end) {
+	for(;start < end; start++) {
+		Token *t = vect_get(tokens, start);
+		if (t->type == TT_SPLITTR && tok_str_eq(t, ":")) {
+			t = vect_get(tokens, ++start);
+			
+			if (t == NULL || !tok_str_eq(t, "import")) {
+				_ast_push_leaf(out, AST_COMPTIME, start);
+				continue;
+			}
+
+			// Imported files are compiled on their own (see phase_2),
+			// so skip over the path.
+			start++;
+		} else if (t->type == TT_DELIMIT && (tok_str_eq(t, "/;") || tok_str_eq(t, ";;"))) {
+			size_t block_start = start;
+			int at;
+			int type = tnsl_block_kind(tokens, start, &at);
+			Node n;
+
+			switch(type) {
+			case BT_FUNCTION:
+				n = ast_function(tokens, &start);
+				break;
+			case BT_MODULE:
+				n = ast_module(tokens, &start);
+				break;
+			case BT_METHOD:
+				n = ast_method(tokens, &start);
+				break;
+			default:
+				n = ast_node(AST_BLOCK, start);
+				n.sub = type;
+				n.at = at;
+				break;
+			}
+			ast_push(out, &n);
+			
+			t = vect_get(tokens, start);
+
+			if (start == block_start) {
+				start = tnsl_find_closing(tokens, start);
+			} else if (tok_str_eq(t, ";;")) {
+				start--;
+			}
+		} else if (tok_str_eq(t, "asm")) {
+			// TODO: top level asm should go where?
+			start++;
+			t = vect_get(tokens, start);
+			if(t != NULL && t->type == TT_LITERAL && t->str_len > 0) {
+				_ast_push_leaf(out, AST_ASM, start);
+			}
+		} else if (tok_str_eq(t, "struct")){
+			start += 2;
+			start = tnsl_find_closing(tokens, start);
+		} else if (tnsl_is_def(tokens, start)) {
+			Node n = ast_fdef(tokens, &start);
+			ast_push(out, &n);
+		}
+	}
+}
+
+void ast_build(SrcFile *file) {
+	ast_file_loop(&file->ast, &file->tokens, 0, file->tokens.count);
+}
+
+
+// Phase 1 - Module building
+bool p1_error = false;
+
+void p1_parse_params(Vector *var_list, Vector *tokens, size_t *pos) {
+	int end = tnsl_find_closing(tokens, *pos);
+	Token *t = vect_get(tokens, *pos);
+
+	if (end < 0) {
+		printf("ERROR: Could not find closing when parsing parameter list \"%.*s\" (%d:%d)\n", t->len, t->data, t->line, t->col);
+		p1_error = true;
+		return;
+	}
+	
+	Variable current_type = {0};
+	current_type.name = SYM_NONE;
+	current_type.type = NULL;
+
+	for(*pos = tnsl_next_non_nl(tokens, *pos); *pos < (size_t) end; *pos = tnsl_next_non_nl(tokens, *pos)) {
+		size_t next = tnsl_next_non_nl(tokens, *pos);
+		t = vect_get(tokens, tnsl_next_non_nl(tokens, *pos));
+
+		if(!tok_str_eq(t, ",") && next < (size_t) end) {
+			if(current_type.name != SYM_NONE) {
+				ptrc_end(&(current_type.ptr_chain));
+			}
+			current_type = tnsl_parse_type(tokens, *pos);
+			
+			if (current_type.location > 0)
+				*pos = tnsl_next_non_nl(tokens, current_type.location - 1);
+		}
+
+		t = vect_get(tokens, *pos);
+		
+		if (current_type.name == SYM_NONE) {
+			printf("ERROR: Expected a valid type.\n");
+			printf("       \"%.*s\" line %d column %d\n\n", t->len, t->data, t->line, t->col);
+			p1_error = true;
+			break;
+		} else if (t->type != TT_DEFWORD) {
+			printf("ERROR: Unexpected token in member/parameter list (was looking for a user defined name)\n");
+			printf("       \"%.*s\" line %d column %d\n\n", t->len, t->data, t->line, t->col);
+			p1_error = true;
+			break;
+		}
+
+		// The name of the variable is "<User defined name> <Dot deliniated type string>"
+		// this is specifically so that types may be defined out of order, and will be
+		// cleaned up when p1_size_structs is called.
+		Variable member = var_copy(&current_type);
+		member.location = -1;
+		Vector name_type = vect_from_nstring(t->data, t->len);
+		vect_push_string(&name_type, " ");
+		vect_push_string(&name_type, sym_str(member.name));
+		member.name = sym_intern_free(vect_as_string(&name_type));
+
+		// Add the member to the struct (the member's type will be resolved later)
+		vect_push(var_list, &member);
+
+		*pos = tnsl_next_non_nl(tokens, *pos);
+		t = vect_get(tokens, *pos);
+
+		if (*pos >= (size_t)end) {
+			break;
+		} else if (tok_str_eq(t, ",") != true) {
+			printf("ERROR: Unexpected token in member list (was looking for a comma to separate members)\n");
+			printf("       \"%.*s\" line %d column %d\n\n", t->len, t->data, t->line, t->col);
+			p1_error = true;
+			break;
+		}
+	}
+	
+	if (current_type.name != SYM_NONE) {
+		ptrc_end(&(current_type.ptr_chain));
+	}
+
+	*pos = end;
+}
+
+void p1_parse_type_list(Vector *var_list, Vector *tokens, size_t *pos) {
+	int end = tnsl_find_closing(tokens, *pos);
+	Token *t = vect_get(tokens, *pos);
+
+	if (end < 0) {
+		printf("ERROR: Could not find closing when parsing parameter list \"%.*s\" (%d:%d)\n", t->len, t->data, t->line, t->col);
+		p1_error = true;
+		return;
+	}
+
+	for(*pos += 1; *pos < (size_t) end;) {
+		Variable to_add = tnsl_parse_type(tokens, *pos);
+
+		if(to_add.location < 0) {
+			t = vect_get(tokens, *pos);
+			printf("ERROR: Could not parse type when in type list ~(%d:%d)\n", t->line, t->col);
+			p1_error = true;
+			break;
+		}
 
 		*pos = to_add.location;
 		to_add.location = -1;
@@ -3346,7 +5069,7 @@ void p1_parse_struct(Module *add, Vector *tokens, size_t *pos) {
 		return;
 	}
 
-	Type to_add = typ_init(t->data, add);
+	Type to_add = typ_init(t->sym, add);
 
 	*pos += 2;
 	int closing = tnsl_find_closing(tokens, *pos);
@@ -3354,14 +5077,14 @@ void p1_parse_struct(Module *add, Vector *tokens, size_t *pos) {
 
 	if(closing < 0 || tok_str_eq(t, "{") != true) {
 		printf("ERROR: Expected a member list (Types and member names enclosed with '{}') when defining struct.\n");
-		printf("       Place one after token \"%s\" line %d column %d\n\n", t->data, t->line, t->col);
+		printf("       Place one after token \"%.*s\" line %d column %d\n\n", t->len, t->data, t->line, t->col);
 		p1_error = true;
 		typ_end(&to_add);
 		return;
 	}
 	
 	p1_parse_params(&(to_add.members), tokens, pos);
-	vect_push(&(add->types), &to_add);
+	mod_add_type(add, &to_add);
 }
 
 void p1_parse_def(Module *root, Vector *tokens, size_t *pos) {
@@ -3383,15 +5106,14 @@ void p1_parse_def(Module *root, Vector *tokens, size_t *pos) {
 		}
 
 		Variable to_add = var_copy(&type);
-		free(to_add.name);
 		to_add.location = *pos;
 
-		Vector name = vect_from_string(t->data);
+		Vector name = vect_from_nstring(t->data, t->len);
 		vect_push_string(&name, " ");
-		vect_push_string(&name, type.name);
-		to_add.name = vect_as_string(&name);
+		vect_push_string(&name, sym_str(type.name));
+		to_add.name = sym_intern_free(vect_as_string(&name));
 
-		vect_push(&root->vars, &to_add);
+		mod_add_var(root, &to_add);
 
 		*pos += 1;
 		t = vect_get(tokens, *pos);
@@ -3425,7 +5147,7 @@ void p1_parse_enum(Module *root, Vector *tokens, size_t *pos) {
 	Token *t = vect_get(tokens, *pos);
 
 	if (end < 0) {
-		printf("ERROR: Could not find closing for enum \"%s\" (%d:%d)\n\n", t->data, t->line, t->col);
+		printf("ERROR: Could not find closing for enum \"%.*s\" (%d:%d)\n\n", t->len, t->data, t->line, t->col);
 		p1_error = true;
 		return;
 	}
@@ -3435,15 +5157,14 @@ void p1_parse_enum(Module *root, Vector *tokens, size_t *pos) {
 
 	if (t == NULL || t->type != TT_DEFWORD) {
 		t = tnsl_find_last_token(tokens, *pos);
-		printf("ERROR: Expected user defined name for enum \"%s\" (%d:%d)\n\n", t->data, t->line, t->col);
+		printf("ERROR: Expected user defined name for enum \"%.*s\" (%d:%d)\n\n", t->len, t->data, t->line, t->col);
 		*pos = end;
 		return;
 	}
 
 	Vector name = vect_from_string("@@");
-	vect_push_string(&name, t->data);
-	Module out = mod_init(vect_as_string(&name), root, root->exported);
-	vect_end(&name);
+	vect_push_nstring(&name, t->data, t->len);
+	Module out = mod_init(sym_intern_free(vect_as_string(&name)), root, root->exported);
 	
 	*pos += 1;
 	t = vect_get(tokens, *pos);
@@ -3451,7 +5172,7 @@ void p1_parse_enum(Module *root, Vector *tokens, size_t *pos) {
 	if (t == NULL || !tok_str_eq(t, "[")) {
 		printf("ERROR: Expected a type after enum name (enclose the type in []) (%d:%d)\n\n", t->line, t->col);
 		p1_error = true;
-		vect_push(&root->submods, &out);
+		mod_add_sub(root, &out);
 		*pos = end;
 		return;
 	}
@@ -3469,15 +5190,14 @@ void p1_parse_enum(Module *root, Vector *tokens, size_t *pos) {
 		}
 
 		Variable to_add = var_copy(&e_type);
-		free(to_add.name);
 		to_add.location = *pos;
 
-		Vector name = vect_from_string(t->data);
+		Vector name = vect_from_nstring(t->data, t->len);
 		vect_push_string(&name, " ");
-		vect_push_string(&name, e_type.name);
-		to_add.name = vect_as_string(&name);
+		vect_push_string(&name, sym_str(e_type.name));
+		to_add.name = sym_intern_free(vect_as_string(&name));
 
-		vect_push(&out.vars, &to_add);
+		mod_add_var(&out, &to_add);
 
 		*pos = tnsl_next_non_nl(tokens, *pos);
 		t = vect_get(tokens, *pos);
@@ -3497,14 +5217,14 @@ void p1_parse_enum(Module *root, Vector *tokens, size_t *pos) {
 		} else if (tok_str_eq(t, ",") || *pos >= (size_t)end) {
 			continue;
 		} else {
-			printf("ERROR: Expected an assignment (= <value>) or a comma after user defined word in enum block \"%s\" (%d:%d)\n\n", t->data, t->line, t->col);
+			printf("ERROR: Expected an assignment (= <value>) or a comma after user defined word in enum block \"%.*s\" (%d:%d)\n\n", t->len, t->data, t->line, t->col);
 			p1_error = true;
 			break;
 		}
 
 	}
 
-	vect_push(&root->submods, &out);
+	mod_add_sub(root, &out);
 	var_end(&e_type);
 	*pos = end;
 }
@@ -3515,23 +5235,18 @@ void p1_parse_function(Module *root, Vector *tokens, size_t *pos) {
 	if (end < 0)
 		return;
 	
-	Function out = func_init("", root);
+	Function out = func_init(sym_intern(""), root);
 
 	for (*pos += 1; *pos < (size_t)end; *pos += 1) {
 		Token *t = vect_get(tokens, *pos);
 		if(t->type == TT_DEFWORD) {
-			free(out.name);
-			Vector copy = vect_from_string(t->data);
-			out.name = vect_as_string(&copy);
-
-			for(size_t i = 0; i < root->funcs.count; i++) {
-				Function *chk = vect_get(&root->funcs, i);
-				if(strcmp(chk->name, out.name) == 0) {
-					printf("ERROR: Redefinition of function with name '%s' at (%d:%d)\n", out.name, t->line, t->col);
-					func_end(&out);
-					*pos = end;
-					return;
-				}
+			out.name = t->sym;
+
+			if(_mod_map_get(&root->func_map, &root->funcs, out.name) != NULL) {
+				printf("ERROR: Redefinition of function with name '%s' at (%d:%d)\n", sym_str(out.name), t->line, t->col);
+				func_end(&out);
+				*pos = end;
+				return;
 			}
 		} else if (tok_str_eq(t, "(")) {
 			p1_parse_params(&(out.inputs), tokens, pos);
@@ -3542,7 +5257,7 @@ void p1_parse_function(Module *root, Vector *tokens, size_t *pos) {
 		}
 	}
 
-	vect_push(&(root->funcs), &out);
+	mod_add_func(root, &out);
 	*pos = end;
 }
 
@@ -3551,7 +5266,7 @@ void p1_parse_method(Module *root, Vector *tokens, size_t *pos) {
 	Token *t = vect_get(tokens, *pos);
 
 	if (end < 0) {
-		printf("ERROR: Could not find closing for block \"%s\" at (%d:%d)\n\n", t->data, t->line, t->col);
+		printf("ERROR: Could not find closing for block \"%.*s\" at (%d:%d)\n\n", t->len, t->data, t->line, t->col);
 		p1_error = true;
 		return;
 	}
@@ -3560,16 +5275,15 @@ void p1_parse_method(Module *root, Vector *tokens, size_t *pos) {
 	t = vect_get(tokens, *pos);
 
 	if (t == NULL || t->type != TT_DEFWORD) {
-		printf("ERROR: Expected user defined type while parsing method block. \"%s\" (%d:%d)\n\n", t->data, t->line, t->col);
+		printf("ERROR: Expected user defined type while parsing method block. \"%.*s\" (%d:%d)\n\n", t->len, t->data, t->line, t->col);
 		p1_error = true;
 		*pos = end;
 		return;
 	}
 
 	Vector mod_name = vect_from_string("_#");
-	vect_push_string(&mod_name, t->data);
-	Module out = mod_init(vect_as_string(&mod_name), root, root->exported);
-	vect_end(&mod_name);
+	vect_push_nstring(&mod_name, t->data, t->len);
+	Module out = mod_init(sym_intern_free(vect_as_string(&mod_name)), root, root->exported);
 
 	for (*pos += 1; *pos < end; *pos += 1) {
 		t = vect_get(tokens, *pos);
@@ -3583,20 +5297,20 @@ void p1_parse_method(Module *root, Vector *tokens, size_t *pos) {
 		}
 	}
 
-	vect_push(&(root->submods), &out);
+	mod_add_sub(root, &out);
 
 	*pos = end;
 }
 
-void p1_file_loop(Artifact *path, Module *root, Vector *tokens, size_t start, size_t end);
+void p1_file_loop(Vector *cache, SrcFile *file, Module *root, Vector *tokens, size_t start, size_t end);
 
-void p1_parse_module(Artifact *path, Module *root, Vector *tokens, size_t *pos) {
+void p1_parse_module(Vector *cache, SrcFile *file, Module *root, Vector *tokens, size_t *pos) {
 	int end = tnsl_find_closing(tokens, *pos);
 	Token *t = vect_get(tokens, *pos);
 	
 	if (end < 0) {
 		t = tnsl_find_last_token(tokens, *pos);
-		printf("ERROR: Unable to find closing for module block \"%s\" (%d:%d)\n\n", t->data, t->line, t->col);
+		printf("ERROR: Unable to find closing for module block \"%.*s\" (%d:%d)\n\n", t->len, t->data, t->line, t->col);
 		return;
 	}
 	
@@ -3613,61 +5327,71 @@ void p1_parse_module(Artifact *path, Module *root, Vector *tokens, size_t *pos)
 	if (t == NULL || t->type != TT_DEFWORD) {
 		t = tnsl_find_last_token(tokens, *pos - 1);
 		if (t != NULL) {
-			printf("ERROR: Expected user defined module name after token \"%s\" (%d:%d) %d\n\n", t->data, t->line, t->col, t->type);
+			printf("ERROR: Expected user defined module name after token \"%.*s\" (%d:%d) %d\n\n", t->len, t->data, t->line, t->col, t->type);
 		}
 		p1_error = true;
 		*pos = end;
 		return;
 	}
-	char *name = t->data;
+	int name = t->sym;
 
-	Module *out = NULL;
-	for(size_t i = 0; i < root->submods.count; i++) {
-		Module *chk = vect_get(&root->submods, i);
-		if (strcmp(chk->name, name) == 0) {
-			out = chk;
-			break;
-		}
-	}
+	Module *out = mod_find_sub(root, name);
 
 	if (out == NULL) {
 		Module tmp = mod_init(name, root, export);
-		p1_file_loop(path, &tmp, tokens, *pos, end);
-		vect_push(&(root->submods), &tmp);
+		p1_file_loop(cache, file, &tmp, tokens, *pos, end);
+		mod_add_sub(root, &tmp);
 	} else {
-		p1_file_loop(path, out, tokens, *pos, end);
-		vect_push(&(root->submods), out);
+		p1_file_loop(cache, file, out, tokens, *pos, end);
+		mod_add_sub(root, out);
 	}
 
 	*pos = end;
 }
 
 
-void p1_parse_file(Artifact *path, Module *root) {
-	char *full_path = art_to_str(path, '/');
-	FILE *fin = fopen(full_path, "r");
+// Catalogs the file at the given path into the module, adding it to the
+// import graph as a dependency of "from" (NULL for the file being compiled).
+// Each file is only cataloged once, no matter how many files import it.
+void p1_parse_file(Vector *cache, SrcFile *from, Artifact *path, Module *root) {
+	SrcFile *file = src_cache_get(cache, path);
 
-	if (fin == NULL) {
-		printf("Unable to open file %s for reading.\n\n", full_path);
-		free(full_path);
+	if (file == NULL) {
+		p1_error = true;
 		return;
 	}
 
-	free(full_path);
-	
-	Vector tokens = parse_file(fin);
-	fclose(fin);
+	// Matching delimiters are relied on everywhere past this point
+	if (file->bad_delims > 0) {
+		p1_error = true;
+		return;
+	}
 
-	p1_file_loop(path, root, &tokens, 0, tokens.count);
+	if (from != NULL)
+		vect_push(&from->imports, &file);
 
-	for (size_t i = 0; i < tokens.count; i++) {
-		Token *t = vect_get(&tokens, i);
-		free(t->data);
+	if (file->state == SRC_OPEN) {
+		printf("ERROR: Import cycle detected, file %s imports itself (directly or indirectly)\n\n", file->path);
+		p1_error = true;
+		return;
+	} else if (file->state == SRC_DONE) {
+		char *mod = mod_full_path(root);
+		if (strcmp(mod, file->module) != 0) {
+			printf("WARNING: File %s was already imported into module \"%s\", it will not be imported into \"%s\"\n\n", file->path, file->module, mod);
+		}
+		free(mod);
+		return;
 	}
-	vect_end(&tokens);
+
+	file->state = SRC_OPEN;
+	file->module = mod_full_path(root);
+
+	p1_file_loop(cache, file, root, &file->tokens, 0, file->tokens.count);
+
+	file->state = SRC_DONE;
 }
 
-void p1_file_loop(Artifact *path, Module *root, Vector *tokens, size_t start, size_t end) {
+void p1_file_loop(Vector *cache, SrcFile *file, Module *root, Vector *tokens, size_t start, size_t end) {
 	for(;start < end; start++) {
 		Token *t = vect_get(tokens, start);
 		if (t->type == TT_SPLITTR && tok_str_eq(t, ":")) {
@@ -3675,24 +5399,22 @@ void p1_file_loop(Artifact *path, Module *root, Vector *tokens, size_t start, si
 			
 			if (t == NULL || !tok_str_eq(t, "import")) {
 				t = tnsl_find_last_token(tokens, start);
-				printf("ERROR: Comptime declarations are not implemented other than 'import' \"%s\" (%d:%d)\n\n", t->data, t->line, t->col);
+				printf("ERROR: Comptime declarations are not implemented other than 'import' \"%.*s\" (%d:%d)\n\n", t->len, t->data, t->line, t->col);
 				p1_error = true;
 				continue;
 			}
 
 			t = vect_get(tokens, ++start);
 			if(t != NULL && t->type == TT_LITERAL) {
-				// Process new path to follow using old path.
-				char *cpy = art_to_str(path, '/');
-				Artifact new_path = art_from_str(cpy, '/');
-				free(cpy);
+				// Process new path to follow using the current file's path.
+				Artifact new_path = art_from_str(file->path, '/');
 
 				// Pop off file name
 				art_pop_str(&new_path);
 				
 				// Copy token data (something like "path/to/file.tnsl" including the quotes)
 				// This path is relative to the current file
-				Vector v = vect_from_string(t->data);
+				Vector v = vect_from_nstring(t->data, t->len);
 				// Pop off last quote, replace with \0
 				vect_pop(&v);
 				vect_as_string(&v);
@@ -3705,7 +5427,7 @@ void p1_file_loop(Artifact *path, Module *root, Vector *tokens, size_t start, si
 				// no more need for path relative to file
 				art_end(&addon);
 
-				p1_parse_file(&new_path, root);
+				p1_parse_file(cache, file, &new_path, root);
 				// Cleanup last remaining artifact
 				art_end(&new_path);
 			}
@@ -3716,7 +5438,7 @@ void p1_file_loop(Artifact *path, Module *root, Vector *tokens, size_t start, si
 				p1_parse_function(root, tokens, &start);
 				break;
 			case BT_MODULE:
-				p1_parse_module(path, root, tokens, &start);
+				p1_parse_module(cache, file, root, tokens, &start);
 				break;
 			case BT_METHOD:
 				p1_parse_method(root, tokens, &start);
@@ -3727,11 +5449,11 @@ void p1_file_loop(Artifact *path, Module *root, Vector *tokens, size_t start, si
 			case BT_CONTROL:
 			case BT_INTERFACE:
 			case BT_OPERATOR:
-				printf("ERROR: Block type not implemented \"%s\" (%d:%d)\n\n", t->data, t->line, t->col);
+				printf("ERROR: Block type not implemented \"%.*s\" (%d:%d)\n\n", t->len, t->data, t->line, t->col);
 				p1_error = true;
 				break;
 			default:
-				printf("ERROR: Unknown block type \"%s\" at file root (%d:%d)\n\n", t->data, t->line, t->col);
+				printf("ERROR: Unknown block type \"%.*s\" at file root (%d:%d)\n\n", t->len, t->data, t->line, t->col);
 				p1_error = true;
 				break;
 			}
@@ -3741,7 +5463,7 @@ void p1_file_loop(Artifact *path, Module *root, Vector *tokens, size_t start, si
 			if (start == block_start) {
 				int chk = tnsl_find_closing(tokens, start);
 				if (chk < 0)
-					printf("ERROR: Could not find closing for \"%s\" (%d:%d)\n\n", t->data, t->line, t->col);
+					printf("ERROR: Could not find closing for \"%.*s\" (%d:%d)\n\n", t->len, t->data, t->line, t->col);
 				else
 					start = chk;
 			} else if (tok_str_eq(t, ";;")) {
@@ -3763,48 +5485,47 @@ void p1_size_type (Module *root, Type *t) {
 	t->size = -1;
 
 	Vector tmp = vect_from_string("_#");
-	vect_push_string(&tmp, t->name);
-	t->module = mod_find_sub(root, vect_as_string(&tmp));
+	vect_push_string(&tmp, sym_str(t->name));
+	t->module = mod_find_sub(root, sym_find(vect_as_string(&tmp)));
 	vect_end(&tmp);
 
 	for(size_t i = 0; i < t->members.count; i++) {
 		Variable *var = vect_get(&t->members, i);
-		char *n_end = strchr(var->name, ' ');
+		char *full = sym_str(var->name);
+		char *n_end = strchr(full, ' ');
 		
 		if (n_end == NULL) {
-			printf("COMPILER ERROR: Did not properly assure type %s had all members with both name and RTN (size_type)\n", t->name);
-			printf("\toffending member: %s\n", var->name);
+			printf("COMPILER ERROR: Did not properly assure type %s had all members with both name and RTN (size_type)\n", sym_str(t->name));
+			printf("\toffending member: %s\n", sym_str(var->name));
 			p1_error = true;
 			sum = -2;
 			break;
 		}
 
-		*n_end = 0;
-		Vector name = vect_from_string(var->name);
 		Artifact rta = art_from_str(n_end + 1, '.');
-		free(var->name);
-		var->name = vect_as_string(&name);
+		var->name = sym_intern_n(full, n_end - full);
 
 		var->offset = sum;
 
 		Type *mt = mod_find_type(root, &rta);
-		art_end(&rta);
 		
 		if(mt == NULL) {
 			// Could not find type
-			char *rtn = art_to_str(&rta, '.');
-			printf("ERROR: Could not find type %s when parsing type %s.\n\n", rtn, t->name);
+			printf("ERROR: Could not find type %s when parsing type %s.\n\n", art_to_str(&rta, '.'), sym_str(t->name));
 			p1_error = true;
-			free(rtn);
+			art_end(&rta);
 			break;
-		} else if (var->ptr_chain.count > 0) {
+		}
+		art_end(&rta);
+
+		if (var->ptr_chain.count > 0) {
 			// Pointer to type, don't need to size
 			sum += 8;
 			var->type = mt;
 			continue;
 		} else if (mt->size == -1) {
 			// Cycle in type definition
-			printf("ERROR: Cyclical type definition %s -> %s\n\n", mt->name, t->name);
+			printf("ERROR: Cyclical type definition %s -> %s\n\n", sym_str(mt->name), sym_str(t->name));
 			p1_error = true;
 			sum = -1;
 			break;
@@ -3822,7 +5543,7 @@ void p1_size_type (Module *root, Type *t) {
 
 void p1_resolve_func_types(Module *root, Function *func) {
 
-	bool method = root->name != NULL && strlen(root->name) > 1 && root->name[0] == '_' && root->name[1] == '#';
+	bool method = mod_is_method(root);
 
 	int reg = 1;
 	if (method)
@@ -3830,22 +5551,18 @@ void p1_resolve_func_types(Module *root, Function *func) {
 	int stack_accum = 0;
 	for (size_t i = 0; i < func->outputs.count; i++) {
 		Variable *var = vect_get(&func->outputs, i);
-		Artifact rtn = art_from_str(var->name, '.');
+		Artifact rtn = art_from_str(sym_str(var->name), '.');
 		Type *t = mod_find_type(root, &rtn);
 
 		if(t == NULL) {
-			char *rt = art_to_str(&rtn, '.');
-			printf("ERROR: Could not find type %s for function %s\n\n", rt, func->name);
-			free(rt);
+			printf("ERROR: Could not find type %s for function %s\n\n", art_to_str(&rtn, '.'), sym_str(func->name));
 			art_end(&rtn);
 			break;
 		}
 
 		art_end(&rtn);
 
-		Vector name = vect_from_string(t->name);
-		free(var->name);
-		var->name = vect_as_string(&name);
+		var->name = t->name;
 		var->type = t;
 
 		// Check where the output should be stored
@@ -3879,10 +5596,11 @@ void p1_resolve_func_types(Module *root, Function *func) {
 	// Stack accum not reset because the stack would get clobbered
 	for (size_t i = 0; i < func->inputs.count; i++) {
 		Variable *var = vect_get(&func->inputs, i);
-		char *n_end = strchr(var->name, ' ');
+		char *full = sym_str(var->name);
+		char *n_end = strchr(full, ' ');
 
 		if (n_end == NULL) {
-			printf("COMPILER ERROR: Did not properly assure function %s had all parameters with both name and RTN (resolve_func_types)\n\n", func->name);
+			printf("COMPILER ERROR: Did not properly assure function %s had all parameters with both name and RTN (resolve_func_types)\n\n", sym_str(func->name));
 			p1_error = true;
 			break;
 		}
@@ -3891,19 +5609,14 @@ void p1_resolve_func_types(Module *root, Function *func) {
 		Type *t = mod_find_type(root, &rtn);
 
 		if(t == NULL) {
-			char *rt = art_to_str(&rtn, '.');
-			printf("ERROR: Could not find type %s for function %s\n\n", rt, func->name);
-			free(rt);
+			printf("ERROR: Could not find type %s for function %s\n\n", art_to_str(&rtn, '.'), sym_str(func->name));
 			art_end(&rtn);
 			break;
 		}
 
 		art_end(&rtn);
 
-		*n_end = 0;
-		Vector name = vect_from_string(var->name);
-		free(var->name);
-		var->name = vect_as_string(&name);
+		var->name = sym_intern_n(full, n_end - full);
 		var->type = t;
 		
 		// Check where the input should be read from
@@ -3970,26 +5683,22 @@ void p1_resolve_types(Module *root) {
 		Variable *v = vect_get(&root->vars, i);
 		// when created, the module was on the stack.  Make sure it is not anymore.
 		v->mod = root;
-		char *n_end = strchr(v->name, ' ');
+		char *full = sym_str(v->name);
+		char *n_end = strchr(full, ' ');
 
 		if (n_end == NULL) {
-			printf("COMPILER ERROR: Not properly formatted variable name \"%s\"\n\n", v->name);
+			printf("COMPILER ERROR: Not properly formatted variable name \"%s\"\n\n", sym_str(v->name));
 			p1_error = true;
 			continue;
 		}
 
 		Artifact rtn = art_from_str(n_end + 1, '.');
-		*n_end = 0;
-		Vector name = vect_from_string("");
-		vect_push_free_string(&name, v->name);
-		v->name = vect_as_string(&name);
+		v->name = sym_intern_n(full, n_end - full);
 
 		Type *t = mod_find_type(root, &rtn);
 		
 		if (t == NULL) {
-			char *rts = art_to_str(&rtn, '.');
-			printf("ERROR: Could not find type \"%s\" for variable \"%s\"\n\n", rts, v->name);
-			free(rts);
+			printf("ERROR: Could not find type \"%s\" for variable \"%s\"\n\n", art_to_str(&rtn, '.'), sym_str(v->name));
 			art_end(&rtn);
 			p1_error = true;
 			continue;
@@ -3998,11 +5707,26 @@ void p1_resolve_types(Module *root) {
 		art_end(&rtn);
 		v->type = t;
 	}
+
+	// The type was just cut off the variable names, so index them again
+	root->var_map = smap_init(&mod_arena);
+	for (size_t i = 0; i < root->vars.count; i++) {
+		Variable *v = vect_get(&root->vars, i);
+		smap_put(&root->var_map, v->name, i);
+	}
 }
 
-void phase_1(Artifact *path, Module *root) {
-	p1_parse_file(path, root);
+void phase_1(Vector *cache, Artifact *path, Module *root) {
+	p1_parse_file(cache, NULL, path, root);
 	p1_resolve_types(root);
+
+	if (p1_error)
+		return;
+
+	for (size_t i = 0; i < cache->count; i++) {
+		SrcFile **file = vect_get(cache, i);
+		ast_build(*file);
+	}
 }
 
 // Phase 2
@@ -4012,11 +5736,15 @@ void phase_1(Artifact *path, Module *root) {
 Scope scope_subscope(Scope *s, char *name) {
 	Vector n = vect_from_string(name);
 	vect_push_string(&n, "#");
-	vect_push_free_string(&n, int_to_str(s->next_const));
+	vect_push_int(&n, s->next_const);
 	s->next_const++;
 
 	Scope out = scope_init(vect_as_string(&n), s->current);
 	out.parent = s;
+	// The parent must not make or free variables while the subscope is in use
+	out.reg_base = s->reg_base | s->reg_used;
+	out.stack_top = out.stack_base = s->stack_top;
+	out.label = _scope_make_label(&out);
 
 	vect_end(&n);
 
@@ -4033,20 +5761,47 @@ bool scope_name_eq(Scope *s, char *name) {
 
 // Scope variable creation and management
 
-int _scope_next_stack_loc(Scope *s, int size) {
-	int sum = -56 - size;
-	
-	if (s->parent != NULL)
-		sum = _scope_next_stack_loc(s->parent, size);
+void _scope_push_var(Vector *vars, VarIndex *idx, Variable *v) {
+	int index = vars->count;
+	vect_push(vars, v);
 
-	for (size_t i = 0; i < s->stack_vars.count; i++) {
-		Variable *v = vect_get(&s->stack_vars, i);
-		if (v->offset - size < sum) {
-			sum = v->offset - size;
+	if (idx->stale || v->name == SYM_TMP)
+		return;
+
+	smap_put(&idx->map, v->name, index);
+	if (index > idx->top)
+		idx->top = index;
+}
+
+void _scope_remove_var(Vector *vars, VarIndex *idx, size_t i) {
+	if ((int)i <= idx->top)
+		idx->stale = true;
+	vect_remove(vars, i);
+}
+
+// First variable in vars with the name, NULL if there is none
+Variable *_scope_find_in(Vector *vars, VarIndex *idx, int name) {
+	if (idx->stale) {
+		smap_clear(&idx->map);
+		idx->top = -1;
+		idx->stale = false;
+		for (size_t i = 0; i < vars->count; i++) {
+			Variable *v = vect_get(vars, i);
+			if (v->name == SYM_TMP)
+				continue;
+			smap_put(&idx->map, v->name, i);
+			idx->top = i;
 		}
 	}
 
-	return sum;
+	int index = smap_get(&idx->map, name);
+	if (index < 0)
+		return NULL;
+	return vect_get(vars, index);
+}
+
+int _scope_next_stack_loc(Scope *s, int size) {
+	return s->stack_top - size;
 }
 
 // Tmp reg masks
@@ -4062,28 +5817,51 @@ int _scope_next_stack_loc(Scope *s, int size) {
 #define RMSK_14 0b010000000
 #define RMSK_15 0b100000000
 
+int _scope_reg_mask(int location) {
+	if (location == 2)
+		return RMSK_B;
+	else if (location > 8)
+		return 1 << (location - 8);
+	return 0;
+}
+
 // Generate a bitmask representing available registers
 int _scope_avail_reg(Scope *s) {
-	int mask = 0b111111111;
-	if (s->parent != NULL) {
-		mask = _scope_avail_reg(s->parent);
-	}
+	return 0b111111111 & ~(s->reg_base | s->reg_used);
+}
 
-	for (size_t i = 0; i < s->reg_vars.count; i++) {
-		Variable *v = vect_get(&s->reg_vars, i);
-		int vmask = 0;
-		
-		if (v->location == 2) {
-			vmask = RMSK_B;
-		} else if (v->location > 8) {
-			vmask = 1;
-			vmask = vmask << (v->location - 8);
-		}
+void _scope_add_reg(Scope *s, Variable *v) {
+	_scope_push_var(&s->reg_vars, &s->reg_index, v);
+	s->reg_used |= _scope_reg_mask(v->location);
+}
+
+// The top is the lowest offset in use.  Variables are not sorted by
+// offset: a tmp of a literal (size -1) is made just above the top.
+void _scope_add_stack(Scope *s, Variable *v) {
+	_scope_push_var(&s->stack_vars, &s->stack_index, v);
+	if (v->offset < s->stack_top)
+		s->stack_top = v->offset;
+}
+
+void _scope_drop_reg(Scope *s, size_t i) {
+	_scope_remove_var(&s->reg_vars, &s->reg_index, i);
 
-		mask &= ~vmask;
+	s->reg_used = 0;
+	for (size_t j = 0; j < s->reg_vars.count; j++) {
+		Variable *v = vect_get(&s->reg_vars, j);
+		s->reg_used |= _scope_reg_mask(v->location);
 	}
+}
+
+void _scope_drop_stack(Scope *s, size_t i) {
+	_scope_remove_var(&s->stack_vars, &s->stack_index, i);
 
-	return mask;
+	s->stack_top = s->stack_base;
+	for (size_t j = 0; j < s->stack_vars.count; j++) {
+		Variable *v = vect_get(&s->stack_vars, j);
+		if (v->offset < s->stack_top)
+			s->stack_top = v->offset;
+	}
 }
 
 // Creates a new tmp variable from an existing variable
@@ -4093,14 +5871,12 @@ Variable scope_mk_tmp(Scope *s, CompData *data, Variable *v) {
 	Variable out = var_copy(v);
 
 	while (_var_ptr_type(&out) == PTYPE_REF) {
-		vect_pop(&out.ptr_chain);
+		ptrc_pop(&out.ptr_chain);
 	}
 
 	int p_typ = _var_ptr_type(v);
 
-	free(out.name);
-	Vector nm = vect_from_string("#tmp");
-	out.name = vect_as_string(&nm);
+	out.name = SYM_TMP;
 
 	if ((is_inbuilt(v->type->name) && p_typ < 1) || p_typ == PTYPE_PTR || p_typ == PTYPE_PTR) {
 		int regs = _scope_avail_reg(s);
@@ -4117,7 +5893,7 @@ Variable scope_mk_tmp(Scope *s, CompData *data, Variable *v) {
 
 			var_op_set(data, &out, v);
 
-			vect_push(&s->reg_vars, &out);
+			_scope_add_reg(s, &out);
 			return var_copy(&out);
 		}
 	}
@@ -4129,7 +5905,7 @@ Variable scope_mk_tmp(Scope *s, CompData *data, Variable *v) {
 
 	var_op_set(data, &out, v);
 
-	vect_push(&s->stack_vars, &out);
+	_scope_add_stack(s, &out);
 	return var_copy(&out);
 }
 
@@ -4141,9 +5917,7 @@ Variable scope_mk_pure_tmp(Scope *s, CompData *data, Variable *v) {
 
 	int p_typ = _var_ptr_type(v);
 
-	free(out.name);
-	Vector nm = vect_from_string("#tmp");
-	out.name = vect_as_string(&nm);
+	out.name = SYM_TMP;
 
 	if ((is_inbuilt(v->type->name) && p_typ < 1) || p_typ == PTYPE_PTR || p_typ == PTYPE_PTR) {
 		int regs = _scope_avail_reg(s);
@@ -4160,7 +5934,7 @@ Variable scope_mk_pure_tmp(Scope *s, CompData *data, Variable *v) {
 
 			var_op_pure_set(data, &out, v);
 
-			vect_push(&s->reg_vars, &out);
+			_scope_add_reg(s, &out);
 			return var_copy(&out);
 		}
 	}
@@ -4172,7 +5946,7 @@ Variable scope_mk_pure_tmp(Scope *s, CompData *data, Variable *v) {
 
 	var_op_pure_set(data, &out, v);
 
-	vect_push(&s->stack_vars, &out);
+	_scope_add_stack(s, &out);
 	return var_copy(&out);
 }
 
@@ -4185,17 +5959,17 @@ Variable scope_mk_stack(Scope *s, CompData *data, Variable *v) {
 	out.location = LOC_STCK;
 	out.offset = loc;
 
-	vect_push_string(&data->text, "\tlea rsp, [rbp - ");
-	vect_push_free_string(&data->text, int_to_str(-loc));
-	vect_push_string(&data->text, "]; Stack variable\n");
+	rope_push_string(&data->text, "\tlea rsp, [rbp - ");
+	rope_push_int(&data->text, -loc);
+	rope_push_string(&data->text, "]; Stack variable\n");
 
-	vect_push(&s->stack_vars, &out);
+	_scope_add_stack(s, &out);
 	return var_copy(&out);
 }
 
 // Checks if a variable is a tmp variable in the scope
 bool scope_is_tmp(Variable *v) {
-	return strcmp(v->name, "#tmp") == 0;
+	return v->name == SYM_TMP;
 }
 
 
@@ -4204,7 +5978,7 @@ void _scope_free_tmp_reg(Scope *s, Variable *v) {
 		Variable *to_free = vect_get(&s->reg_vars, i);
 		if (to_free->location == v->location) {
 			var_end(to_free);
-			vect_remove(&s->reg_vars, i);
+			_scope_drop_reg(s, i);
 			i--;
 		}
 	}
@@ -4217,7 +5991,7 @@ void _scope_free_stack_var(Scope *s, CompData *data, Variable *v) {
 		Variable *to_free = vect_get(&s->stack_vars, i);
 		if(to_free->offset == target_top) {
 			var_end(to_free);
-			vect_remove(&s->stack_vars, i);
+			_scope_drop_stack(s, i);
 			i--;
 		} else if (new_top > to_free->offset) {
 			new_top = to_free->offset;
@@ -4226,9 +6000,9 @@ void _scope_free_stack_var(Scope *s, CompData *data, Variable *v) {
 
 	if (new_top > target_top) {
 		// Restore rsp
-		vect_push_string(&data->text, "\tlea rsp, [rbp - ");
-		vect_push_free_string(&data->text, int_to_str(-new_top));
-		vect_push_string(&data->text, "]; Tmp variable removed\n");
+		rope_push_string(&data->text, "\tlea rsp, [rbp - ");
+		rope_push_int(&data->text, -new_top);
+		rope_push_string(&data->text, "]; Tmp variable removed\n");
 	}
 }
 
@@ -4250,7 +6024,7 @@ void scope_free_to(Scope *s, CompData *data, Variable *v) {
 		Variable *cur = vect_get(&s->stack_vars, i - 1);
 		if (cur->offset < v->offset || v->offset == 0) {
 			var_end(cur);
-			vect_pop(&s->stack_vars);
+			_scope_drop_stack(s, i - 1);
 			freed = true;
 		} else {
 			break;
@@ -4259,9 +6033,9 @@ void scope_free_to(Scope *s, CompData *data, Variable *v) {
 
 	if (freed || v->offset == 0) {
 		int next_loc = _scope_next_stack_loc(s, 0);
-		vect_push_string(&data->text, "\tlea rsp, [rbp - ");
-		vect_push_free_string(&data->text, int_to_str(-next_loc));
-		vect_push_string(&data->text, "]; Scope free to\n");
+		rope_push_string(&data->text, "\tlea rsp, [rbp - ");
+		rope_push_int(&data->text, -next_loc);
+		rope_push_string(&data->text, "]; Scope free to\n");
 	}
 }
 
@@ -4282,7 +6056,7 @@ void scope_free_all_tmp(Scope* s, CompData *data) {
 		Variable *to_free = vect_get(&s->reg_vars, i);
 		if (to_free->location < RMSK_10) {
 			var_end(to_free);
-			vect_remove(&s->reg_vars, i);
+			_scope_drop_reg(s, i);
 			i--;
 		}
 	}
@@ -4290,9 +6064,9 @@ void scope_free_all_tmp(Scope* s, CompData *data) {
 	int new_top = 0;
 	for (size_t i = 0; i < s->stack_vars.count; i++) {
 		Variable *to_free = vect_get(&s->stack_vars, i);
-		if(strcmp(to_free->name, "#tmp") == 0) {
+		if(to_free->name == SYM_TMP) {
 			var_end(to_free);
-			vect_remove(&s->stack_vars, i);
+			_scope_drop_stack(s, i);
 			i--;
 
 			if (new_top == 0) {
@@ -4305,9 +6079,9 @@ void scope_free_all_tmp(Scope* s, CompData *data) {
 
 	if (new_top > 0) {
 		// Restore rsp
-		vect_push_string(&data->text, "\tlea rsp, [rbp - ");
-		vect_push_free_string(&data->text, int_to_str(-new_top));
-		vect_push_string(&data->text, "]; All tmp free\n");
+		rope_push_string(&data->text, "\tlea rsp, [rbp - ");
+		rope_push_int(&data->text, -new_top);
+		rope_push_string(&data->text, "]; All tmp free\n");
 	}
 }
 
@@ -4316,18 +6090,17 @@ Variable scope_mk_stmp(Scope *s, CompData *data, Variable *v)
 {
 	Variable out = var_copy(v);
 
-	Vector name = vect_from_string("#tmp");
-	out.name = vect_as_string(&name);
+	out.name = SYM_TMP;
 	
 	int loc = _scope_next_stack_loc(s, _var_pure_size(v));
 	out.location = LOC_STCK;
 	out.offset = loc;
 	
-	vect_push_string(&data->text, "\tlea rsp, [rbp - ");
-	vect_push_free_string(&data->text, int_to_str(-loc));
-	vect_push_string(&data->text, "]; Stack variable\n");
+	rope_push_string(&data->text, "\tlea rsp, [rbp - ");
+	rope_push_int(&data->text, -loc);
+	rope_push_string(&data->text, "]; Stack variable\n");
 
-	vect_push(&s->stack_vars, &out);
+	_scope_add_stack(s, &out);
 	return var_copy(&out);
 }
 
@@ -4356,7 +6129,7 @@ Variable scope_mk_var(Scope *s, CompData *data, Variable *v) {
 
 			out.offset = 0;
 
-			vect_push(&s->reg_vars, &out);
+			_scope_add_reg(s, &out);
 			return var_copy(&out);
 		}
 	}
@@ -4366,50 +6139,37 @@ Variable scope_mk_var(Scope *s, CompData *data, Variable *v) {
 	out.location = LOC_STCK;
 	out.offset = loc;
 
-	vect_push_string(&data->text, "\tlea rsp, [rbp - ");
-	vect_push_free_string(&data->text, int_to_str(-loc));
-	vect_push_string(&data->text, "]; Stack variable\n");
+	rope_push_string(&data->text, "\tlea rsp, [rbp - ");
+	rope_push_int(&data->text, -loc);
+	rope_push_string(&data->text, "]; Stack variable\n");
 
-	vect_push(&s->stack_vars, &out);
+	_scope_add_stack(s, &out);
 	return var_copy(&out);
 }
 
-Variable _scope_get_var(Scope *s, char *name) {
-	for (size_t i = 0; i < s->reg_vars.count; i++) {
-		Variable *v = vect_get(&s->reg_vars, i);
-		if (strcmp(v->name, name) == 0)
-			return var_copy(v);
-	}
-
-	for (size_t i = 0; i < s->stack_vars.count; i++) {
-		Variable *v = vect_get(&s->stack_vars, i);
-		if (strcmp(v->name, name) == 0)
-			return var_copy(v);
-	}
-
-	if (s->parent == NULL) {
-		Variable out = {0};
-		out.name = NULL;
-		return out;
+// Borrowed, the variable stays owned by the scope that holds it
+Variable *_scope_get_var(Scope *s, int name) {
+	for (; s != NULL; s = s->parent) {
+		Variable *v = _scope_find_in(&s->reg_vars, &s->reg_index, name);
+		if (v == NULL)
+			v = _scope_find_in(&s->stack_vars, &s->stack_index, name);
+		if (v != NULL)
+			return v;
 	}
-
-	return _scope_get_var(s->parent, name);
+	return NULL;
 }
 
 
 Variable scope_get_var(Scope *s, Artifact *name) {
 	Variable out = {0};
-	out.name = NULL;
+	out.name = SYM_NONE;
 
-	if (name->count == 1) {
-		char *full = art_to_str(name, '.');
-		out = _scope_get_var(s, full);
-		free(full);
+	if (name->segs.count == 1) {
+		Variable *found = _scope_get_var(s, art_get(name, 0));
+		if (found != NULL)
+			return var_copy(found);
 	}
 
-	if (out.name != NULL)
-		return out;
-
 	Variable *mod_search = mod_find_var(s->current, name);
 	
 	if (mod_search == NULL)
@@ -4472,11 +6232,11 @@ int op_order(Token *t) {
 		if (t == NULL)
 			printf("NULL\n\n");
 		else
-		 	printf(" \"%s\" (%d:%d)", t->data, t->line, t->col);
+		 	printf(" \"%.*s\" (%d:%d)", t->len, t->data, t->line, t->col);
 		return -1;
 	}
 
-	int l = strlen(t->data);
+	int l = t->len;
 	
 	if(l == 1) {
 		switch(t->data[0]) {
@@ -4541,7 +6301,7 @@ Variable _eval(Scope *s, CompData *data, Vector *tokens, size_t start, size_t en
 Variable _eval_call(Scope *s, CompData *data, Vector *tokens, Function *f, Variable *self, size_t start) {
 	
 	Variable out = {0};
-	out.name = NULL;
+	out.name = SYM_NONE;
 
 	Variable pin = scope_get_stack_pin(s);
 
@@ -4585,9 +6345,9 @@ Variable _eval_call(Scope *s, CompData *data, Vector *tokens, Function *f, Varia
 			Variable set = scope_mk_stmp(s, data, cur);
 			Variable from = _eval(s, data, tokens, pstart, pend);
 
-			if (from.name == NULL) {
+			if (from.name == SYM_NONE) {
 				Token *p = vect_get(tokens, pstart);
-				printf("ERROR: Expected value for parameter \"%s\" in call to function \"%s\" (%d:%d)\n", cur->name, f->name, p->line, p->col);
+				printf("ERROR: Expected value for parameter \"%s\" in call to function \"%s\" (%d:%d)\n", sym_str(cur->name), sym_str(f->name), p->line, p->col);
 				p2_error = true;
 				i = f->inputs.count;
 				break;
@@ -4650,9 +6410,9 @@ Variable _eval_call(Scope *s, CompData *data, Vector *tokens, Function *f, Varia
 			// eval and set
 			Variable from = _eval(s, data, tokens, pstart, pend);
 
-			if (from.name == NULL) {
+			if (from.name == SYM_NONE) {
 				Token *p = vect_get(tokens, pstart);
-				printf("ERROR: Expected value for parameter \"%s\" in call to function \"%s\" (%d:%d)\n", cur->name, f->name, p->line, p->col);
+				printf("ERROR: Expected value for parameter \"%s\" in call to function \"%s\" (%d:%d)\n", sym_str(cur->name), sym_str(f->name), p->line, p->col);
 				p2_error = true;
 				i = f->inputs.count;
 				break;
@@ -4692,19 +6452,19 @@ Variable _eval_call(Scope *s, CompData *data, Vector *tokens, Function *f, Varia
 
 	// set stack to where it needs to be for call
 	scope_free_to(s, data, &inpin);
-	if (inpin.name != NULL) {
+	if (inpin.name != SYM_NONE) {
 		var_end(&inpin);
 	}
 
 	// Sixth, make call
-	vect_push_string(&data->text, "\tcall ");
-	vect_push_free_string(&data->text, mod_label_prefix(f->module));
-	vect_push_string(&data->text, f->name);
-	vect_push_string(&data->text, "; Function call\n\n");
+	rope_push_string(&data->text, "\tcall ");
+	rope_push_string(&data->text, mod_label_prefix(f->module));
+	rope_push_string(&data->text, sym_str(f->name));
+	rope_push_string(&data->text, "; Function call\n\n");
 
 	// Seventh, return output
 	scope_free_to(s, data, &pin);
-	if (out.name != NULL) {
+	if (out.name != SYM_NONE) {
 		var_end(&pin);
 	}
 	return out;
@@ -4712,12 +6472,12 @@ Variable _eval_call(Scope *s, CompData *data, Vector *tokens, Function *f, Varia
 
 Variable _eval_dot(Scope *s, CompData *data, Vector *tokens, size_t start, size_t end) {
 	Token *t = vect_get(tokens, start);
-	Artifact name = art_from_str(t->data, '.');
+	Artifact name = art_from_str(sym_str(t->sym), '.');
 
 	if (start == end - 1) {
 		Variable v = scope_get_var(s, &name);
-		if (v.name == NULL) {
-			printf("ERROR: Failed to find singlet variable or call in dot chain \"%s\" (%d:%d)\n\n", t->data, t->line, t->col);
+		if (v.name == SYM_NONE) {
+			printf("ERROR: Failed to find singlet variable or call in dot chain \"%.*s\" (%d:%d)\n\n", t->len, t->data, t->line, t->col);
 			p2_error = true;
 		}
 		art_end(&name);
@@ -4731,7 +6491,7 @@ Variable _eval_dot(Scope *s, CompData *data, Vector *tokens, size_t start, size_
 	for (; start < end; start = tnsl_next_non_nl(tokens, start)) {
 		// Try match variable
 
-		if (v.name != NULL) {
+		if (v.name != SYM_NONE) {
 			art_end(&name);
 			name = art_from_str("", '.');
 			break;
@@ -4743,16 +6503,16 @@ Variable _eval_dot(Scope *s, CompData *data, Vector *tokens, size_t start, size_
 			start++;
 			t = vect_get(tokens, start);
 			if (t->type != TT_DEFWORD) {
-				printf("ERROR: Expected defword after '.' operator but found \"%s\" (%d:%d)\n\n", t->data, t->line, t->col);
+				printf("ERROR: Expected defword after '.' operator but found \"%.*s\" (%d:%d)\n\n", t->len, t->data, t->line, t->col);
 				return v;
 			}
-			art_add_str(&name, t->data);
+			art_add_sym(&name, t->sym);
 			v = scope_get_var(s, &name);
 		} else if (tok_str_eq(t, "(")) {
 			// Call
 			break;
 		} else {
-			printf("ERROR: Failed to find variable or call in dot chain \"%s\" (%d:%d)\n\n", t->data, t->line, t->col);
+			printf("ERROR: Failed to find variable or call in dot chain \"%.*s\" (%d:%d)\n\n", t->len, t->data, t->line, t->col);
 			return v;
 		}
 	}
@@ -4762,11 +6522,11 @@ Variable _eval_dot(Scope *s, CompData *data, Vector *tokens, size_t start, size_
 
 		// After found var, or in call.  We need to check.
 		if (tok_str_eq(t, "(")) {
-			if (v.name == NULL) {
+			if (v.name == SYM_NONE) {
 				Function *f = mod_find_func(s->current, &name);
 				if (f == NULL) {
 					t = vect_get(tokens, start - 1);
-					printf("ERROR: Could not find function \"%s\" (%d:%d)\n\n", t->data, t->line, t->col);
+					printf("ERROR: Could not find function \"%.*s\" (%d:%d)\n\n", t->len, t->data, t->line, t->col);
 					art_end(&name);
 					return v;
 				}
@@ -4775,7 +6535,7 @@ Variable _eval_dot(Scope *s, CompData *data, Vector *tokens, size_t start, size_
 				Function *m = mod_find_func(v.type->module, &name);
 				if (m == NULL) {
 					t = vect_get(tokens, start - 1);
-					printf("ERROR: Could not find function \"%s\" (%d:%d)\n\n", t->data, t->line, t->col);
+					printf("ERROR: Could not find function \"%.*s\" (%d:%d)\n\n", t->len, t->data, t->line, t->col);
 					art_end(&name);
 					return v;
 				}
@@ -4794,23 +6554,23 @@ Variable _eval_dot(Scope *s, CompData *data, Vector *tokens, size_t start, size_
 		} else if (tok_str_eq(t, ".")) {
 			Token *next = vect_get(tokens, start + 1);
 			if (next == NULL || next->type != TT_DEFWORD) {
-				printf("ERROR: Expected defword after dot in dotchain: \"%s\" (%d:%d)\n", t->data, t->line, t->col);
+				printf("ERROR: Expected defword after dot in dotchain: \"%.*s\" (%d:%d)\n", t->len, t->data, t->line, t->col);
 				art_end(&name);
 				return v;
 			}
-			char *m_name = next->data;
+			Token *m_name = next;
 			next = vect_get(tokens, start + 2);
 			if (next == NULL || !tok_str_eq(next, "(")) {
-				Variable m = var_op_member(data, &v, m_name);
-				if (m.name == NULL) {
-					printf("ERROR: Unable to find member variable: \"%s\" of variable \"%s\" (%d:%d)\n", next->data, v.name, next->line, next->col);
+				Variable m = var_op_member(data, &v, m_name->sym);
+				if (m.name == SYM_NONE) {
+					printf("ERROR: Unable to find member variable: \"%.*s\" of variable \"%s\" (%d:%d)\n", next->len, next->data, sym_str(v.name), next->line, next->col);
 					art_end(&name);
 					return v;
 				}
 				var_end(&v);
 				v = m;
 			} else if (tok_str_eq(next, "(")) {
-				art_add_str(&name, m_name);
+				art_add_sym(&name, m_name->sym);
 			}
 			start++;
 		}
@@ -4822,105 +6582,163 @@ Variable _eval_dot(Scope *s, CompData *data, Vector *tokens, size_t start, size_
 }
 
 Variable _eval_literal(Scope *s, CompData *data, Vector *tokens, size_t literal) {
-	Variable out = var_init("#literal", NULL);
+	Variable out = var_init(SYM_LITERAL, NULL);
 	Token *t = vect_get(tokens, literal);
 	
 	if (t->data[0] == '"') {
 		// handle str
-		Vector str_dat = tnsl_unquote_str(t->data);
-		char *label = scope_gen_const_label(s);
+		char *label = sym_str(scope_gen_const_label(s));
 		
-		vect_push_string(&data->data, label);
-		vect_push_string(&data->data, "#ptr:\n\tdq ");
-		vect_push_free_string(&data->data, int_to_str(str_dat.count));
+		rope_push_string(&data->data, label);
+		rope_push_string(&data->data, "#ptr:\n\tdq ");
+		rope_push_int(&data->data, t->str_len);
 		
-		if (str_dat.count > 0)
-			vect_push_string(&data->data, "\n\tdb ");
-
-		for (size_t i = 0; i < str_dat.count; i++) {
-			char *ch = vect_get(&str_dat, i);
-			vect_push_free_string(&data->data, int_to_str(*ch));
-			if (i < str_dat.count - 1) {
-				vect_push_string(&data->data, ", ");
+		if (t->str_len > 0)
+			rope_push_string(&data->data, "\n\tdb ");
+
+		for (int i = 0; i < t->str_len; i++) {
+			rope_push_int(&data->data, t->str[i]);
+			if (i < t->str_len - 1) {
+				rope_push_string(&data->data, ", ");
 			}
 		}
-		vect_push_string(&data->data, "\n");
-		vect_end(&str_dat);
+		rope_push_string(&data->data, "\n");
 		var_end(&out);
 
-		vect_push_string(&data->data, label);
-		vect_push_string(&data->data, ":\n\tdq ");
-		vect_push_string(&data->data, label);
-		vect_push_string(&data->data, "#ptr\n\n");
+		rope_push_string(&data->data, label);
+		rope_push_string(&data->data, ":\n\tdq ");
+		rope_push_string(&data->data, label);
+		rope_push_string(&data->data, "#ptr\n\n");
 
-		out = var_init(label, typ_get_inbuilt("uint8"));
+		out = var_init(sym_intern(label), typ_get_inbuilt(SYM_UINT8));
 		out.mod = NULL;
 		out.location = LOC_DATA;
-		free(label);
 		int arr_t = PTYPE_ARR;
-		vect_push(&out.ptr_chain, &arr_t);
+		ptrc_push(&out.ptr_chain, arr_t);
 	} else if (tok_str_eq(t, "false") || tok_str_eq(t, "true")) {
-		out.type = typ_get_inbuilt("bool");
+		out.type = typ_get_inbuilt(SYM_BOOL);
 		if (tok_str_eq(t, "true")) {
-			vect_push_string(&data->text, "\tmov rax, 1\n");
-			vect_push_string(&data->text, "\ttest rax, rax ; literal bool\n\n");
+			rope_push_string(&data->text, "\tmov rax, 1\n");
+			rope_push_string(&data->text, "\ttest rax, rax ; literal bool\n\n");
 			out.offset = 1;
 		} else {
-			vect_push_string(&data->text, "\tmov rax, 0\n");
-			vect_push_string(&data->text, "\ttest rax, rax ; literal bool\n\n");
+			rope_push_string(&data->text, "\tmov rax, 0\n");
+			rope_push_string(&data->text, "\ttest rax, rax ; literal bool\n\n");
 			out.offset = 0;
 		}
 		out.location = LOC_LITL;
 	} else {
 		out.location = LOC_LITL;
-		out.type = typ_get_inbuilt("int");
-		if (t->data[0] == '\'')
-			out.offset = tnsl_unquote_char(t->data + 1);
-		else
-			out.offset = tnsl_parse_number(t);
+		out.type = typ_get_inbuilt(SYM_INT);
+		out.offset = t->value;
 	}
 	return out;
 }
 
-// Main implementation, recursive
-Variable _eval(Scope *s, CompData *data, Vector *tokens, size_t start, size_t end) {
-	Token *t = vect_get(tokens, start);
-	if (start == end - 1 && t->type == TT_LITERAL) {
-		return _eval_literal(s, data, tokens, start);
-	} 
+// Expression tree node.  Operators are split out of the token range by
+// _eval_parse, everything between two operators (literals, dot chains,
+// calls and delimited groups) is left as a leaf over its tokens.
+typedef struct {
+	int op; // op_order of the operator, -1 for leaves
+	size_t tok, start, end;
+	int delim; // first delimiter in a leaf
+	int bad; // unclosed delimiter at the end of the range, -1 if none
+	int lhs, rhs;
+} ExprNode;
+
+typedef struct {
+	Vector *tokens;
+	Vector nodes;
+	size_t cur, end;
+} ExprParse;
+
+int _eval_parse_push(ExprParse *p, ExprNode *n) {
+	vect_push(&p->nodes, n);
+	return p->nodes.count - 1;
+}
 
-	int op = -1;
-	int op_pos = 0;
-	int delim = -1;
+// Takes tokens up to the next operator as a leaf
+int _eval_parse_leaf(ExprParse *p) {
+	ExprNode n = {-1, 0, p->cur, p->cur, -1, -1, -1, -1};
 
-	for(size_t i = start; i < end; i++) {
-		t = vect_get(tokens, i);
+	while (p->cur < p->end) {
+		Token *t = vect_get(p->tokens, p->cur);
 		if (t->type == TT_DELIMIT) {
-			if(delim < 0) {
-				delim = i;
-			}
-			int dcl = tnsl_find_closing(tokens, i);
+			if (n.delim < 0)
+				n.delim = p->cur;
+			int dcl = tnsl_find_closing(p->tokens, p->cur);
 			if (dcl < 0) {
-				printf("ERROR: could not find closing for delimiter \"%s\" (%d:%d)\n", t->data, t->line, t->col);
-				p2_error = true;
-				i = end;
+				// operators past this point are not seen
+				n.bad = p->cur;
+				p->cur = p->end;
 			} else {
-				i = dcl;
-			}
-		} else if (t->type == TT_AUGMENT) {
-			if (op_order(t) > op || (op_order(t) == op && op == 9)) {
-				op = op_order(t);
-				op_pos = i;
+				p->cur = dcl + 1;
 			}
+		} else if (t->type == TT_AUGMENT && op_order(t) >= 2) {
+			break;
+		} else {
+			p->cur++;
 		}
 	}
 
-	// Found first delim and last lowest priority op
-	Variable out;
-	out.name = NULL;
+	if (p->cur > p->end)
+		p->cur = p->end;
+	n.end = p->cur;
+	return _eval_parse_push(p, &n);
+}
+
+// Pratt parser over op_order.  Lower order binds tighter, boolean logic
+// groups to the left and everything else groups to the right.
+int _eval_parse(ExprParse *p, int rbp) {
+	int lhs = _eval_parse_leaf(p);
+
+	while (p->cur < p->end) {
+		Token *t = vect_get(p->tokens, p->cur);
+		int op = op_order(t);
+		int lbp = 11 - op;
+		if (lbp <= rbp)
+			break;
+
+		ExprNode n = {op, p->cur, 0, 0, -1, -1, lhs, -1};
+		p->cur++;
+		n.rhs = _eval_parse(p, op == 9 ? lbp : lbp - 1);
+
+		ExprNode *l = vect_get(&p->nodes, n.lhs);
+		ExprNode *r = vect_get(&p->nodes, n.rhs);
+		n.start = l->start;
+		n.end = r->end;
+		n.bad = r->bad;
+		lhs = _eval_parse_push(p, &n);
+	}
+
+	return lhs;
+}
+
+// Walks the tree built by _eval_parse
+Variable _eval_node(Scope *s, CompData *data, Vector *tokens, Vector *tree, int i) {
+	ExprNode *n = vect_get(tree, i);
+	size_t start = n->start;
+	size_t end = n->end;
+	int delim = n->delim;
+	size_t op_pos = n->tok;
+	int op = n->op;
+
+	Token *t = vect_get(tokens, start);
+	if (start == end - 1 && t->type == TT_LITERAL) {
+		return _eval_literal(s, data, tokens, start);
+	} 
+
+	if (n->bad >= 0) {
+		t = vect_get(tokens, n->bad);
+		printf("ERROR: could not find closing for delimiter \"%.*s\" (%d:%d)\n", t->len, t->data, t->line, t->col);
+		p2_error = true;
+	}
+
+	Variable out = {0};
+	out.name = SYM_NONE;
 	out.location = LOC_LITL;
 
-	if (op < 2){
+	if (n->op < 0) {
 		// handle dot chain
 		Token *d = vect_get(tokens, delim);
 		if (delim == -1 || (d->data[0] == '(' && delim > start)) {
@@ -4941,7 +6759,7 @@ Variable _eval(Scope *s, CompData *data, Vector *tokens, size_t start, size_t en
 				if (dcl < end - 1) {
 					// Extra tokens after paren are not yet supported
 					d = vect_get(tokens, dcl);
-					printf("Unexpected token after parenthesis \"%s\" (%d:%d)\n\n", d->data, d->line, d->col);
+					printf("Unexpected token after parenthesis \"%.*s\" (%d:%d)\n\n", d->len, d->data, d->line, d->col);
 					return out;
 				} else {
 					// Eval paren as expression
@@ -4981,11 +6799,11 @@ Variable _eval(Scope *s, CompData *data, Vector *tokens, size_t start, size_t en
 	
 	Token *op_token = vect_get(tokens, op_pos);
 
-	// Based on op_token, split the two halves and recurse.
+	// Based on op_token, evaluate the two halves.
 	
 	// if boolean, eval left to right, not right to left
 	if (op == 9) {
-		Variable lhs = _eval(s, data, tokens, start, op_pos);
+		Variable lhs = _eval_node(s, data, tokens, tree, n->lhs);
 
 		char chk = op_token->data[0];
 		if (op_token->data[0] == '!') {
@@ -4993,23 +6811,23 @@ Variable _eval(Scope *s, CompData *data, Vector *tokens, size_t start, size_t en
 			chk = op_token->data[1];
 		}
 
-		Variable rhs;
+		Variable rhs = {0};
 		if (chk == '&') {
-			vect_push_string(&data->text, "\tjz ");
-			vect_push_free_string(&data->text, scope_gen_bool_label(s));
-			vect_push_string(&data->text, " ; boolean and\n");
-			rhs = _eval(s, data, tokens, op_pos + 1, end);
+			rope_push_string(&data->text, "\tjz ");
+			scope_gen_bool_label(&data->text, s);
+			rope_push_string(&data->text, " ; boolean and\n");
+			rhs = _eval_node(s, data, tokens, tree, n->rhs);
 		} else if (chk == '|') {
-			vect_push_string(&data->text, "\tjnz ");
-			vect_push_free_string(&data->text, scope_gen_bool_label(s));
-			vect_push_string(&data->text, " ; boolean or\n");
-			rhs = _eval(s, data, tokens, op_pos + 1, end);
+			rope_push_string(&data->text, "\tjnz ");
+			scope_gen_bool_label(&data->text, s);
+			rope_push_string(&data->text, " ; boolean or\n");
+			rhs = _eval_node(s, data, tokens, tree, n->rhs);
 		} else if (chk == '^') {
 			
 		}
 
-		vect_push_free_string(&data->text, scope_gen_bool_label(s));
-		vect_push_string(&data->text, ": ; boolean end\n");
+		scope_gen_bool_label(&data->text, s);
+		rope_push_string(&data->text, ": ; boolean end\n");
 		scope_adv_bool_label(s);
 		
 		var_end(&rhs);
@@ -5017,13 +6835,13 @@ Variable _eval(Scope *s, CompData *data, Vector *tokens, size_t start, size_t en
 	}
 	
 	if (op_pos == start) {
-		Variable rhs = _eval(s, data, tokens, op_pos + 1, end);
+		Variable rhs = _eval_node(s, data, tokens, tree, n->rhs);
 		if (op_token->data[0] == '~') {
 			Variable store;
 			var_op_reference(data, &store, &rhs);
 			var_end(&rhs);
 			
-			int *ptype = vect_get(&store.ptr_chain, store.ptr_chain.count - 1);
+			int *ptype = ptrc_get(&store.ptr_chain, store.ptr_chain.count - 1);
 			*ptype = PTYPE_PTR;
 			
 			rhs = scope_mk_tmp(s, data, &store);
@@ -5038,7 +6856,7 @@ Variable _eval(Scope *s, CompData *data, Vector *tokens, size_t start, size_t en
 			var_op_not(data, &out);
 			return out;
 		} else if (tok_str_eq(op_token, "len")){
-			out = var_init("#literal", typ_get_inbuilt("uint"));
+			out = var_init(SYM_LITERAL, typ_get_inbuilt(SYM_UINT));
 			out.location = LOC_LITL;
 			out.offset = _var_size(&rhs);
 			var_end(&rhs);
@@ -5049,7 +6867,7 @@ Variable _eval(Scope *s, CompData *data, Vector *tokens, size_t start, size_t en
 			return rhs;
 		}
 	} else if (op_pos == end - 1) {
-		Variable lhs = _eval(s, data, tokens, start, op_pos);
+		Variable lhs = _eval_node(s, data, tokens, tree, n->lhs);
 		if (tok_str_eq(op_token, "++")) {
 			var_op_inc(data, &lhs);
 		} else if (tok_str_eq(op_token, "--")) {
@@ -5061,15 +6879,15 @@ Variable _eval(Scope *s, CompData *data, Vector *tokens, size_t start, size_t en
 		return lhs;
 	}
 	
-	Variable rhs = _eval(s, data, tokens, op_pos + 1, end);
+	Variable rhs = _eval_node(s, data, tokens, tree, n->rhs);
 
-	if (rhs.name == NULL) {
+	if (rhs.name == SYM_NONE) {
 		return out;
 	}
 
-	out = _eval(s, data, tokens, start, op_pos);
+	out = _eval_node(s, data, tokens, tree, n->lhs);
 
-	if (out.name == NULL) {
+	if (out.name == SYM_NONE) {
 		return rhs;
 	}
 	
@@ -5082,7 +6900,7 @@ Variable _eval(Scope *s, CompData *data, Vector *tokens, size_t start, size_t en
 		out = tmp;
 	}
 	
-	if (strlen(op_token->data) == 1) {
+	if (op_token->len == 1) {
 		switch(op_token->data[0]) {
 		case '+':
 			var_op_add(data, &out, &rhs);
@@ -5118,7 +6936,7 @@ Variable _eval(Scope *s, CompData *data, Vector *tokens, size_t start, size_t en
 			var_op_gt(data, &out, &rhs);
 			break;
 		}
-	} else if (strlen(op_token->data) == 2){
+	} else if (op_token->len == 2){
 		switch(op_token->data[0]) {
 		case '!':
 			if (op_token->data[1] == '&') {
@@ -5143,7 +6961,7 @@ Variable _eval(Scope *s, CompData *data, Vector *tokens, size_t start, size_t en
 			var_op_bsr(data, &out, &rhs);
 			break;
 		}
-	} else if (strlen(op_token->data) == 3){
+	} else if (op_token->len == 3){
 		switch(op_token->data[0]) {
 		case '!':
 			if (op_token->data[1] == '=') {
@@ -5168,27 +6986,24 @@ Variable _eval(Scope *s, CompData *data, Vector *tokens, size_t start, size_t en
 	return out;
 }
 
-// TODO: Operator evaluation, variable members, literals, function calls
-Variable eval(Scope *s, CompData *out, Vector *tokens, size_t *pos, bool keep, Variable *out_type) {
-	Variable store;
 
-	size_t start = *pos;
-	size_t end = start;
-	for (; end < tokens->count; end++) {
-		Token *chk = vect_get(tokens, end);
-		if(chk->type == TT_SPLITTR) {
-			break;
-		} else if (chk->type == TT_DELIMIT) {
-			int i = tnsl_find_closing(tokens, end);
-			if(i > 0) {
-				end = i;
-				continue;
-			}
-			break;
-		}
-	}
+// Main implementation, builds the expression tree in one pass and then
+// evaluates it.  The tree lives in p2_scratch.
+Variable _eval(Scope *s, CompData *data, Vector *tokens, size_t start, size_t end) {
+	ExprParse p = {0};
+	p.tokens = tokens;
+	p.nodes = vect_init_in(&p2_scratch, sizeof(ExprNode));
+	p.cur = start;
+	p.end = end;
+
+	int root = _eval_parse(&p, 0);
+	return _eval_node(s, data, tokens, &p.nodes, root);
+}
 
-	store = _eval(s, out, tokens, start, end);
+// TODO: Operator evaluation, variable members, literals, function calls
+// Evaluates an expression statement (see ast_expr)
+Variable eval(Scope *s, CompData *out, Vector *tokens, size_t start, size_t end, bool keep, Variable *out_type) {
+	Variable store = _eval(s, out, tokens, start, end);
 	scope_free_all_tmp(s, out);
 	
 	if (keep) {
@@ -5198,7 +7013,6 @@ Variable eval(Scope *s, CompData *out, Vector *tokens, size_t *pos, bool keep, V
 		store = tmp;
 	}
 	
-	*pos = end;
 	return store;
 }
 
@@ -5211,42 +7025,35 @@ void eval_strict_zero(CompData *out, Vector *tokens, Variable *v) {
 		size = v->type->size * _var_ptr_type(v); 
 	}
 
-	vect_push_free_string(&out->data, _var_get_datalabel(v));
-	vect_push_string(&out->data, ":\n");
+	rope_push_free_string(&out->data, _var_get_datalabel(v));
+	rope_push_string(&out->data, ":\n");
 
 	if (array) {
-		vect_push_string(&out->data, "\tdq ");
-		vect_push_free_string(&out->data, int_to_str(_var_ptr_type(v)));
-		vect_push_string(&out->data, "\n");
+		rope_push_string(&out->data, "\tdq ");
+		rope_push_int(&out->data, _var_ptr_type(v));
+		rope_push_string(&out->data, "\n");
 	}
 
-	vect_push_string(&out->data, "\tdb 0");
+	rope_push_string(&out->data, "\tdb 0");
 	for (int i = 1; i < size; i++) {
-		vect_push_string(&out->data, ", 0");
+		rope_push_string(&out->data, ", 0");
 	}
-	vect_push_string(&out->data, "\n\n");
+	rope_push_string(&out->data, "\n\n");
 }
 
 void eval_strict_literal(Vector *out, Vector *tokens, Variable *v, size_t start) {
 	Token *cur = vect_get(tokens, start);
 	
 	if (cur->type != TT_LITERAL) {
-		printf("ERROR: Expected literal value, got \"%s\" (%d:%d)\n\n", cur->data, cur->line, cur->col);
+		printf("ERROR: Expected literal value, got \"%.*s\" (%d:%d)\n\n", cur->len, cur->data, cur->line, cur->col);
 		p2_error = true;
 		return;
 	} else if (cur->data[0] == '"') {
-		printf("ERROR: Unexpected string literal (wanted numeric or character value), got \"%s\" (%d:%d)\n\n", cur->data, cur->line, cur->col);
+		printf("ERROR: Unexpected string literal (wanted numeric or character value), got \"%.*s\" (%d:%d)\n\n", cur->len, cur->data, cur->line, cur->col);
 		p2_error = true;
 		return;
 	}
 	
-	char *numstr;
-	if (cur->data[0] == '\'') {
-		numstr = int_to_str(tnsl_unquote_char(cur->data));
-	} else {
-		numstr = int_to_str(tnsl_parse_number(cur));
-	}
-
 	char *str;
 	
 	switch(_var_size(v)) {
@@ -5261,7 +7068,7 @@ void eval_strict_literal(Vector *out, Vector *tokens, Variable *v, size_t start)
 	}
 
 	vect_push_string(out, str);
-	vect_push_free_string(out, numstr);
+	vect_push_int(out, cur->value);
 	vect_push_string(out, "; Numeric literal\n");
 }
 
@@ -5271,20 +7078,19 @@ void eval_strict_ptr(Module *mod, Vector *out, Vector *tokens, Variable *v, size
 void eval_strict_arr(Module *mod, Vector *out, Vector *tokens, Variable *v, size_t start, char *datalab, int *ntharr) {
 	Vector store = vect_from_string(datalab);
 	vect_push_string(&store, "#ptr");
-	vect_push_free_string(&store, int_to_str(*ntharr));
+	vect_push_int(&store, *ntharr);
 	vect_push_string(&store, ":\n");
 	*ntharr += 1;
 	
 	// TODO array eval loop
 	
 	Variable strip = var_copy(v);
-	vect_pop(&strip.ptr_chain);
+	ptrc_pop(&strip.ptr_chain);
 	
 	Token *cur = vect_get(tokens, start);
 	if (cur->data[0] == '\"') {
-		Vector data = tnsl_unquote_str(cur->data);
 		vect_push_string(&store, "\tdq ");
-		vect_push_free_string(&store, int_to_str(data.count));
+		vect_push_int(&store, cur->str_len);
 		vect_push_string(&store, "\n");
 
 		// char array
@@ -5304,15 +7110,14 @@ void eval_strict_arr(Module *mod, Vector *out, Vector *tokens, Variable *v, size
 			break;
 		}
 
-		for(size_t i = 0; i < data.count; i++) {
-			char *num = vect_get(&data, i);
-			vect_push_free_string(&store, int_to_str(*num));
-			if (i + 1 < data.count) {
+		for(int i = 0; i < cur->str_len; i++) {
+			vect_push_int(&store, cur->str[i]);
+			if (i + 1 < cur->str_len) {
 				vect_push_string(&store, ", ");
 			}
 		}
 
-		if (data.count == 0) {
+		if (cur->str_len == 0) {
 			vect_push_string(&store, "0");
 		}
 
@@ -5340,7 +7145,7 @@ void eval_strict_arr(Module *mod, Vector *out, Vector *tokens, Variable *v, size
 		}
 		
 		vect_push_string(&store, "\tdq ");
-		vect_push_free_string(&store, int_to_str(count));
+		vect_push_int(&store, count);
 		vect_push_string(&store, "\n");
 
 		first = true;
@@ -5368,7 +7173,7 @@ void eval_strict_arr(Module *mod, Vector *out, Vector *tokens, Variable *v, size
 			}
 		}
 	} else {
-		printf("ERROR: Expected array but found \"%s\" (%d:%d)\n\n", cur->data, cur->line, cur->col);
+		printf("ERROR: Expected array but found \"%.*s\" (%d:%d)\n\n", cur->len, cur->data, cur->line, cur->col);
 	}
 	var_end(&strip);
 	
@@ -5395,11 +7200,11 @@ void eval_strict_ptr(Module *mod, Vector *out, Vector *tokens, Variable *v, size
 				cur = tnsl_find_last_token(tokens, start);
 				break;
 			} else if (cur->type == TT_DEFWORD) {
-				art_add_str(&v_art, cur->data);
+				art_add_sym(&v_art, cur->sym);
 			} else if (tok_str_eq(cur, "\n") || tok_str_eq(cur, ",")) {
 				break;
 			} else if (!tok_str_eq(cur, ".")) {
-				printf("ERROR: Unexpected token in pointer declaration (file level) \"%s\", (%d:%d)\n\n", cur->data, cur->line, cur->col);
+				printf("ERROR: Unexpected token in pointer declaration (file level) \"%.*s\", (%d:%d)\n\n", cur->len, cur->data, cur->line, cur->col);
 				p2_error = true;
 				break;
 			}
@@ -5408,9 +7213,7 @@ void eval_strict_ptr(Module *mod, Vector *out, Vector *tokens, Variable *v, size
 		// Find var and get data label
 		Variable *ptr = mod_find_var(mod, &v_art);
 		if (ptr == NULL) {
-			char *v_name = art_to_str(&v_art, '.');
-			printf("ERROR: Could not find variable \"%s\" for pointer value (%d:%d)\n\n", v_name, cur->line, cur->col);
-			free(v_name);
+			printf("ERROR: Could not find variable \"%s\" for pointer value (%d:%d)\n\n", art_to_str(&v_art, '.'), cur->line, cur->col);
 		}
 		vect_push_string(out, "\tdq ");
 		vect_push_free_string(out, _var_get_datalabel(ptr));
@@ -5421,7 +7224,7 @@ void eval_strict_ptr(Module *mod, Vector *out, Vector *tokens, Variable *v, size
 		vect_push_string(out, "\tdq ");
 		vect_push_string(out, datalab);
 		vect_push_string(out, "#ptr");
-		vect_push_free_string(out, int_to_str(*ntharr));
+		vect_push_int(out, *ntharr);
 		
 		if (_var_ptr_type(v) < 1) {
 			vect_push_string(out, " + 8 ; ref to pointer\n");
@@ -5435,7 +7238,7 @@ void eval_strict_ptr(Module *mod, Vector *out, Vector *tokens, Variable *v, size
 		eval_strict_literal(out, tokens, v, start);
 	} else {
 		// Not impl
-		printf("ERROR: Unexpected token when parsing a pointer value at \"%s\" (%d:%d)\n\n", cur->data, cur->line, cur->col);
+		printf("ERROR: Unexpected token when parsing a pointer value at \"%.*s\" (%d:%d)\n\n", cur->len, cur->data, cur->line, cur->col);
 		p2_error = true;
 	}
 }
@@ -5444,7 +7247,7 @@ void eval_strict_composite(Module *mod, Vector *out, Vector *tokens, Variable *v
 	Token *cur = vect_get(tokens, start);
 
 	if (!tok_str_eq(cur, "{")) {
-		printf("ERROR: Expected composite value (enclosed with '{}'), got \"%s\" (%d:%d)\n\n", cur->data, cur->line, cur->col);
+		printf("ERROR: Expected composite value (enclosed with '{}'), got \"%.*s\" (%d:%d)\n\n", cur->len, cur->data, cur->line, cur->col);
 		p2_error = true;
 		return;
 	}
@@ -5501,88 +7304,64 @@ void eval_strict(CompData *out, Vector *tokens, Variable *v, size_t start) {
 		eval_strict_literal(&store, tokens, v, start + 2);
 	}
 
-	vect_push_string(&out->data, vect_as_string(&store));
+	rope_push_string(&out->data, vect_as_string(&store));
 	free(datalab);
 	vect_end(&store);
 }
 
 // Compile a top-level definition
-void p2_compile_fdef(Module *root, CompData *out, Vector *tokens, size_t *pos) {
-	Variable type = tnsl_parse_type(tokens, *pos);
-	*pos = type.location;
-	var_end(&type);
-
-	size_t start = *pos;
-	Variable *cur;
-	while (*pos < tokens->count && !tok_str_eq(vect_get(tokens, *pos), "\n")) {
-		Token *t = vect_get(tokens, *pos);
-
-		if (start == *pos) {
-			if (t->type != TT_DEFWORD) {
-				printf("ERROR: Expected variable name (file), got \"%s\" (%d:%d)\n\n", t->data, t->line, t->col);
-				p2_error = true;
-				return;
-			}
-			
-			Artifact v_art = art_from_str(t->data, '.');
+void p2_compile_fdef(Module *root, CompData *out, Vector *tokens, Node *n) {
+	Variable *cur = NULL;
+	for (size_t i = 0; i < n->children.count; i++) {
+		Node *c = vect_get(&n->children, i);
+		Token *t = vect_get(tokens, c->tok);
+
+		if (c->kind == AST_BAD_NAME) {
+			printf("ERROR: Expected variable name (file), got \"%.*s\" (%d:%d)\n\n", t->len, t->data, t->line, t->col);
+			p2_error = true;
+			return;
+		} else if (c->kind == AST_NAME) {
+			Artifact v_art = art_from_str(sym_str(t->sym), '.');
 			cur = mod_find_var(root, &v_art);
 			art_end(&v_art);
 			
 			if (cur == NULL) {
-				printf("ERROR: Definition should have been cataloged but was not \"%s\" (%d:%d)\n\n", t->data, t->line, t->col);
+				printf("ERROR: Definition should have been cataloged but was not \"%.*s\" (%d:%d)\n\n", t->len, t->data, t->line, t->col);
 				p2_error = true;
 				return;
 			} else if (cur->location == 0) {
-				printf("ERROR: Redefinition of variable \"%s\" (%d:%d)\n\n", t->data, t->line, t->col);
+				printf("ERROR: Redefinition of variable \"%.*s\" (%d:%d)\n\n", t->len, t->data, t->line, t->col);
 				p2_error = true;
 				return;
 			}
-		} else if (t->type == TT_DELIMIT) {
-			*pos = tnsl_find_closing(tokens, *pos);
-		} else if (tok_str_eq(t, ",")) {
-			if (*pos - start > 1) {
-				eval_strict(out, tokens, cur, start);
-			} else if(*pos - start > 0) {
-				eval_strict_zero(out, tokens, cur);
-			}
-			start = *pos + 1;
+		} else if (c->end - c->start > 1) {
+			eval_strict(out, tokens, cur, c->start);
+		} else if(c->end - c->start > 0) {
+			eval_strict_zero(out, tokens, cur);
 		}
-
-		*pos += 1;
-	}
-
-	if (*pos - start > 1) {
-		eval_strict(out, tokens, cur, start);
-	} else if(*pos - start > 0) {
-		eval_strict_zero(out, tokens, cur);
 	}
 }
 
 // Compiles a variable definition inside a function block
-void p2_compile_def(Scope *s, CompData *out, Vector *tokens, size_t *pos, Vector *p_list) {
-
-	Variable type = tnsl_parse_type(tokens, *pos);
-	*pos = type.location;
+void p2_compile_def(Scope *s, CompData *out, Vector *tokens, Node *n, Artifact *p_list) {
+	Variable type = var_copy(&n->type);
 
-	Artifact t_art = art_from_str(type.name, '.');
+	Artifact t_art = art_from_str(sym_str(type.name), '.');
 	type.type = mod_find_type(s->current, &t_art);
 	art_end(&t_art);
 
-	size_t start = *pos;
-	while (*pos < tokens->count) {
-		Token *t = vect_get(tokens, *pos);
+	for (size_t i = 0; i < n->children.count; i++) {
+		Node *c = vect_get(&n->children, i);
+		Token *t = vect_get(tokens, c->tok);
 		
-		if (start == *pos) {
-			if (t->type != TT_DEFWORD) {
-				printf("ERROR: Expected variable name, got \"%s\" (%d:%d)\n\n", t->data, t->line, t->col);
-				p2_error = true;
-				return;
-			}
-
+		if (c->kind == AST_BAD_NAME) {
+			printf("ERROR: Expected variable name, got \"%.*s\" (%d:%d)\n\n", t->len, t->data, t->line, t->col);
+			p2_error = true;
+			var_end(&type);
+			return;
+		} else if (c->kind == AST_NAME) {
 			// Define new scope var
-			free(type.name);
-			Vector nm = vect_from_string(t->data);
-			type.name = vect_as_string(&nm);
+			type.name = t->sym;
 			Variable tmp;
 			if (_var_ptr_type(&type) != PTYPE_REF && art_contains(p_list, type.name)) {
 				tmp = scope_mk_stack(s, out, &type);
@@ -5590,375 +7369,239 @@ void p2_compile_def(Scope *s, CompData *out, Vector *tokens, size_t *pos, Vector
 				tmp = scope_mk_var(s, out, &type);
 			}
 			var_end(&tmp);
-		} else if (t->type == TT_DELIMIT) {
-			*pos = tnsl_find_closing(tokens, *pos);
-		} else if (tok_str_eq(t, ",")) {
-			// Split def
-			if(*pos - start > 1) {
-				Variable store = _eval(s, out, tokens, start, *pos);
-				scope_free_all_tmp(s, out);
-				var_end(&store);
-			}
-			start = *pos + 1;
-		} else if (tok_str_eq(t, ";") || tok_str_eq(t, "\n")) {
-			break;
+		} else {
+			Variable store = _eval(s, out, tokens, c->start, c->end);
+			scope_free_all_tmp(s, out);
+			var_end(&store);
 		}
-		*pos += 1;
 	}
 
 	var_end(&type);
-	if (*pos - start > 1) {
-		Variable store = _eval(s, out, tokens, start, *pos);
-		scope_free_all_tmp(s, out);
-		var_end(&store);
-	}
 }
 
 // TODO (depends on top-level defs working)
-void p2_compile_enum(Module *root, CompData *out, Vector *tokens, size_t *pos) {
-	int end = tnsl_find_closing(tokens, *pos);
-	Token *t = vect_get(tokens, *pos);
-	
-	if(end < 0) {
-		printf("ERROR: Could not find closing for enum \"%s\" (%d:%d)\n\n", t->data, t->line, t->col);
-		p2_error = true;
-		return;
-	}
-
+void p2_compile_enum(Module *root, CompData *out, Vector *tokens, Node *n) {
 }
 
 void _p2_func_scope_end(CompData *out, Scope *fs) {
 	// No multi returns atm
 	
-	vect_push_string(&out->text, "\tlea rsp, [rbp - 56]\n");
-	vect_push_string(&out->text, "\tpop r15\n");
-	vect_push_string(&out->text, "\tpop r14\n");
-	vect_push_string(&out->text, "\tpop r13\n");
-	vect_push_string(&out->text, "\tpop r12\n");
-	vect_push_string(&out->text, "\tpop r11\n");
-	vect_push_string(&out->text, "\tpop r10\n");
-	vect_push_string(&out->text, "\tpop rbp\n"); // restore stack frame
-	vect_push_string(&out->text, "\tret ; Scope end\n");
+	rope_push_string(&out->text, "\tlea rsp, [rbp - 56]\n");
+	rope_push_string(&out->text, "\tpop r15\n");
+	rope_push_string(&out->text, "\tpop r14\n");
+	rope_push_string(&out->text, "\tpop r13\n");
+	rope_push_string(&out->text, "\tpop r12\n");
+	rope_push_string(&out->text, "\tpop r11\n");
+	rope_push_string(&out->text, "\tpop r10\n");
+	rope_push_string(&out->text, "\tpop rbp\n"); // restore stack frame
+	rope_push_string(&out->text, "\tret ; Scope end\n");
 
 }
 
-void p2_compile_control(Scope *s, Function *f, CompData *out, Vector *tokens, size_t *pos, Vector *p_list);
+void p2_compile_control(Scope *s, Function *f, CompData *out, Vector *tokens, Node *n, Artifact *p_list);
 
-void p2_wrap_control(Scope *s, Function *f, CompData *out, Vector *tokens, size_t *pos, Vector *p_list) {
+void p2_wrap_control(Scope *s, Function *f, CompData *out, Vector *tokens, Node *n, Artifact *p_list) {
 	Scope sub = scope_subscope(s, "wrap");
 
-	int end;
-	Token *cur;
-	bool first = true;
-	for (;*pos < tokens->count;) {
-		end = tnsl_find_closing(tokens, *pos);
-		cur = vect_get(tokens, *pos);
-		if (end < 0 || (!tok_str_eq(cur, "/;") && !tok_str_eq(cur, ";;"))) {
-			break;
-		}
+	for (size_t i = 0; i < n->children.count; i++) {
+		p2_compile_control(&sub, f, out, tokens, vect_get(&n->children, i), p_list);
+	}
 
-		cur = vect_get(tokens, *pos + 1);
-		
-		if (tok_str_eq(cur, "if") && first) {
-			p2_compile_control(&sub, f, out, tokens, pos, p_list);
-			first = false;
-		} else if (tok_str_eq(cur, "else") && !first) {
-			p2_compile_control(&sub, f, out, tokens, pos, p_list);
-		} else {
-			if (tok_str_eq(cur, "else") && first) {
-				printf("ERROR: Expected if block before else block (%d:%d)\n\n", cur->line, cur->col);
-			}
-			break;
-		}
-		
-		*pos = end;
+	if (n->at >= 0) {
+		Token *cur = vect_get(tokens, n->at);
+		printf("ERROR: Expected if block before else block (%d:%d)\n\n", cur->line, cur->col);
 	}
 	
-	vect_push_free_string(&out->text, scope_label_end(&sub));
-	vect_push_string(&out->text, ":\n\n");
+	scope_label_end(&out->text, &sub);
+	rope_push_string(&out->text, ":\n\n");
 	scope_end(&sub);
 }
 
-// TODO loop blocks, if blocks, else blocks
-void p2_compile_control(Scope *s, Function *f, CompData *out, Vector *tokens, size_t *pos, Vector *p_list) {
-	int end = tnsl_find_closing(tokens, *pos);
-	Token *t = vect_get(tokens, *pos);
-	
-	if(end < 0) {
-		printf("ERROR: Could not find closing for control block \"%s\" (%d:%d)\n\n", t->data, t->line, t->col);
-		p2_error = true;
-		return;
-	}
-
-	*pos += 1;
-	t = vect_get(tokens, *pos);
-
-	Scope sub;
-
-	// Generate wrap for if if none exists
-	if (tok_str_eq(t, "if") || tok_str_eq(t, "else")) {
-		if (s->parent == NULL || !scope_name_eq(s, "wrap")) {
-			*pos -= 1;
-			p2_wrap_control(s, f, out, tokens, pos, p_list);
-			return;
+// Return statement, leaves the function
+void _p2_compile_return(Scope *s, Function *f, CompData *out, Vector *tokens, Node *n) {
+	if (f->outputs.count > 0) {
+		if (n->sub) {
+			Variable *out_type = vect_get(&f->outputs, 0);
+			Variable e = eval(s, out, tokens, n->start, n->end, true, out_type);
+			var_end(&e);
+		} else {
+			Token *t = vect_get(tokens, n->tok);
+			printf("ERROR: Attempt to return from a function without a value, but the function requires one (%d:%d)", t->line, t->col);
+			p2_error = true;
 		}
 	}
+	_p2_func_scope_end(out, s);
+}
 
-	// Generate subscope
-	if (tok_str_eq(t, "if") || tok_str_eq(t, "else")) {
-		t = vect_get(tokens, *pos + 1);
-		if (tok_str_eq(t, "if")) {
-			*pos += 1;
-			sub = scope_subscope(s, "elif");
-		} else {
-			t = vect_get(tokens, *pos);
-			sub = scope_subscope(s, t->data);
-		}
-	} else if (t->type != TT_KEYWORD || !tok_str_eq(t, "loop")) {
-		printf("ERROR: Expected control block type ('loop' or 'if'), found \"%s\" (%d:%d)\n", t->data, t->line, t->col);
+void _p2_compile_asm(CompData *out, Vector *tokens, Node *n) {
+	Token *t = vect_get(tokens, n->tok);
+	if(t->type != TT_LITERAL || t->data[0] != '"') {
+		printf("ERROR: Expected string literal after asm keyword (%d:%d)\n", t->line, t->col);
 		p2_error = true;
-		*pos = end;
-		return;
 	} else {
-		sub = scope_subscope(s, t->data);
-	}
-	
-	// Find pre and post control statements
-	int build = -1;
-	int rep = -1;
-	for (*pos += 1; *pos < end; *pos += 1) {
-		t = vect_get(tokens, *pos);
-		
-		if (tok_str_eq(t, "(")) {
-			build = *pos;
-			*pos = tnsl_find_closing(tokens, *pos);
-		} else if (tok_str_eq(t, "[")) {
-			rep = *pos;
-			*pos = tnsl_find_closing(tokens, *pos);
-		} else {
-			break;
-		}
+		rope_push_string(&out->text, "\t");
+		rope_push_string(&out->text, t->str);
+		rope_push_string(&out->text, "; User insert asm\n");
 	}
+}
 
-	if (build > -1) {
-		// Generate pre-control statements
-		size_t start = tnsl_next_non_nl(tokens, build);
-		int b_end = tnsl_find_closing(tokens, build);
-		build = start;
-
-		for (;start <= build && build <= b_end; build = tnsl_next_non_nl(tokens, build)) {
-			if (build == start && tnsl_is_def(tokens, start)) {
-				p2_compile_def(&sub, out, tokens, &start, p_list);
-				build = start;
-			}
+// TODO loop blocks, if blocks, else blocks
+void p2_compile_control(Scope *s, Function *f, CompData *out, Vector *tokens, Node *n, Artifact *p_list) {
+	Token *t;
 
-			t = vect_get(tokens, build);
-			if (tok_str_eq(t, ";") || tok_str_eq(t, ")")) {
-				if (build != start) {
-					// Eval, check ending
-					Variable v = _eval(&sub, out, tokens, start, build);
-					scope_free_all_tmp(&sub, out);
-					
-					if (v.type != NULL && strcmp(v.type->name, "bool") == 0 && tok_str_eq(t, ")")) {
-						build = start - 1;
-						start = b_end;
-						vect_push_string(&out->text, "\tjz ");
-						vect_push_free_string(&out->text, scope_label_end(&sub));
-						vect_push_string(&out->text, "; Conditional start\n");
-					} else {
-						start = build + 1;
-					}
-					
-					if (v.name != NULL)
-						var_end(&v);
+	if (n->kind == AST_WRAP) {
+		p2_wrap_control(s, f, out, tokens, n, p_list);
+		return;
+	} else if (n->sub == CTRL_BAD) {
+		t = vect_get(tokens, n->at);
+		printf("ERROR: Expected control block type ('loop' or 'if'), found \"%.*s\" (%d:%d)\n", t->len, t->data, t->line, t->col);
+		p2_error = true;
+		return;
+	}
 
-				} else {
-					start = build + 1;
-				}
-			} else if (t->type == TT_DELIMIT) {
-				build = tnsl_find_closing(tokens, build);
-			}
+	Scope sub = scope_subscope(s, CTRL_NAMES[n->sub]);
+	
+	// Generate pre-control statements
+	int build = -1;
+	size_t b_end = 0;
+	for (size_t i = 0; i < n->pre.count; i++) {
+		Node *c = vect_get(&n->pre, i);
+		if (c->kind == AST_DEF) {
+			p2_compile_def(&sub, out, tokens, c, p_list);
+			continue;
 		}
 
-		if (build > b_end) {
-			build = -1;
+		// Eval, check ending
+		Variable v = _eval(&sub, out, tokens, c->start, c->end);
+		scope_free_all_tmp(&sub, out);
+		
+		bool cond = c->sub && v.type != NULL && v.type->name == SYM_BOOL;
+		if (cond) {
+			build = c->tok;
+			b_end = c->end;
+			rope_push_string(&out->text, "\tjz ");
+			scope_label_end(&out->text, &sub);
+			rope_push_string(&out->text, "; Conditional start\n");
 		}
-	}
-
-	vect_push_free_string(&out->text, scope_label_start(&sub));
-	vect_push_string(&out->text, ": ; Start label\n");
-
-	// Main loop statements
-	*pos = tnsl_next_non_nl(tokens, *pos - 1);
-	for(; *pos < end; *pos = tnsl_next_non_nl(tokens, *pos)) {
-		t = vect_get(tokens, *pos);
-		if (tok_str_eq(t, "/;") || tok_str_eq(t, ";;")) {
-			size_t b_open = *pos;
-			
-			if(tnsl_block_type(tokens, *pos) == BT_CONTROL) {
-				p2_compile_control(&sub, f, out, tokens, pos, p_list);
-			} else {
-				printf("ERROR: Only control blocks (if, else, loop, switch) are valid inside functions (%d:%d)\n\n", t->line, t->col);
-				p2_error = true;
-				*pos = end - 1;
-			}
-
-			if (*pos == b_open) {
-				*pos = tnsl_find_closing(tokens, b_open);
-			} else if (tok_str_eq(t, ";;")) {
-				*pos -= 1;
-			}
+		
+		if (v.name != SYM_NONE)
+			var_end(&v);
+		if (cond)
+			break;
+	}
 
-		} else if (t->type == TT_KEYWORD) {
-			if(tok_str_eq(t, "return")) {
-				t = vect_get(tokens, *pos + 1);
-				if (f->outputs.count > 0) {
-					if (*pos + 1 < end && !tok_str_eq(t, "\n")) {
-						*pos += 1;
-						Variable *out_type = vect_get(&f->outputs, 0);
-						Variable e = eval(&sub, out, tokens, pos, true, out_type);
-						var_end(&e);
-					} else {
-						t = vect_get(tokens, *pos);
-						printf("ERROR: Attempt to return from a function without a value, but the function requires one (%d:%d)", t->line, t->col);
-						p2_error = true;
-					}
-				}
-				_p2_func_scope_end(out, s);
-				*pos = end;
-			} else if (tok_str_eq(t, "asm")) {
-				t = vect_get(tokens, ++(*pos));
-				if(t->type != TT_LITERAL || t->data[0] != '"') {
-					printf("ERROR: Expected string literal after asm keyword (%d:%d)\n", t->line, t->col);
-					p2_error = true;
-				} else {
-					Vector asm_str = tnsl_unquote_str(t->data);
-					vect_push_string(&out->text, "\t");
-					vect_push_string(&out->text, vect_as_string(&asm_str));
-					vect_push_string(&out->text, "; User insert asm\n");
-					vect_end(&asm_str);
-				}
-			} else if (tok_str_eq(t, "continue") || tok_str_eq(t, "break")) {
-				printf("ERROR: This keyword will be implemented in a future commit \"%s\" (%d:%d)\n", t->data, t->line, t->col);
+	scope_label_start(&out->text, &sub);
+	rope_push_string(&out->text, ": ; Start label\n");
+
+	// Main loop statements
+	for (size_t i = 0; i < n->children.count; i++) {
+		Node *c = vect_get(&n->children, i);
+		t = vect_get(tokens, c->tok);
+
+		if (c->kind == AST_CONTROL || c->kind == AST_WRAP) {
+			p2_compile_control(&sub, f, out, tokens, c, p_list);
+		} else if (c->kind == AST_BLOCK) {
+			tnsl_block_report(tokens, c->sub, c->at);
+			printf("ERROR: Only control blocks (if, else, loop, switch) are valid inside functions (%d:%d)\n\n", t->line, t->col);
+			p2_error = true;
+		} else if (c->kind == AST_RETURN) {
+			_p2_compile_return(&sub, f, out, tokens, c);
+		} else if (c->kind == AST_ASM) {
+			_p2_compile_asm(out, tokens, c);
+		} else if (c->kind == AST_KEYWORD) {
+			if (tok_str_eq(t, "continue") || tok_str_eq(t, "break")) {
+				printf("ERROR: This keyword will be implemented in a future commit \"%.*s\" (%d:%d)\n", t->len, t->data, t->line, t->col);
 				p2_error = true;
 			} else {
-				printf("ERROR: Keyword not implemented inside control blocks \"%s\" (%d:%d)\n", t->data, t->line, t->col);
+				printf("ERROR: Keyword not implemented inside control blocks \"%.*s\" (%d:%d)\n", t->len, t->data, t->line, t->col);
 				p2_error = true;
 			}
-		} else if (tnsl_is_def(tokens, *pos)) {
-			p2_compile_def(&sub, out, tokens, pos, p_list);
-		} else if (*pos == end) {
-			break;
+		} else if (c->kind == AST_DEF) {
+			p2_compile_def(&sub, out, tokens, c, p_list);
 		} else {
-			// TODO: figure out eval parameter needs (maybe needs start and end size_t?)
-			// and how eval will play into top level defs (if at all)
-			Variable e = eval(&sub, out, tokens, pos, false, NULL);
-			if (e.name != NULL)
+			Variable e = eval(&sub, out, tokens, c->start, c->end, false, NULL);
+			if (e.name != SYM_NONE)
 				var_end(&e);
 		}
 	}
 
-	vect_push_free_string(&out->text, scope_label_rep(&sub));
-	vect_push_string(&out->text, ": ; Rep label\n");
+	scope_label_rep(&out->text, &sub);
+	rope_push_string(&out->text, ": ; Rep label\n");
 
-	if (rep > -1) {
-		// Generate post-control statements
-		size_t start = tnsl_next_non_nl(tokens, rep);
-		int r_end = tnsl_find_closing(tokens, rep);
-		rep = start;
+	// Generate post-control statements
+	int rep = -1;
+	for (size_t i = 0; i < n->post.count; i++) {
+		Node *c = vect_get(&n->post, i);
+		if (c->kind == AST_DEF) {
+			p2_compile_def(&sub, out, tokens, c, p_list);
+			continue;
+		}
 
-		for (;start <= rep && rep <= r_end; rep = tnsl_next_non_nl(tokens, rep)) {
-			if (rep == start && tnsl_is_def(tokens, start)) {
-				p2_compile_def(&sub, out, tokens, &start, p_list);
-				rep = start;
-			}
+		// Eval, check ending
+		Variable v = _eval(&sub, out, tokens, c->start, c->end);
+		scope_free_all_tmp(&sub, out);
 
-			t = vect_get(tokens, rep);
-			if (tok_str_eq(t, ";") || tok_str_eq(t, "]")) {
-				if (rep != start) {
-					// Eval, check ending
-					Variable v = _eval(&sub, out, tokens, start, rep);
-					scope_free_all_tmp(&sub, out);
-					if (v.type != NULL && strcmp(v.type->name, "bool") == 0 && tok_str_eq(t, "]") && scope_name_eq(&sub, "loop")) {
-						rep = start - 1;
-						start = r_end;
-						vect_push_string(&out->text, "\tjnz ");
-						vect_push_free_string(&out->text, scope_label_start(&sub));
-						vect_push_string(&out->text, "; Conditional rep\n");
-					} else {
-						start = rep + 1;
-					}
-					if (v.name != NULL)
-						var_end(&v);
-				} else {
-					start = rep + 1;
-				}
-			} else if (t->type == TT_DELIMIT) {
-				rep = tnsl_find_closing(tokens, rep);
-			}
+		bool cond = c->sub && v.type != NULL && v.type->name == SYM_BOOL && n->sub == CTRL_LOOP;
+		if (cond) {
+			rep = c->tok;
+			rope_push_string(&out->text, "\tjnz ");
+			scope_label_start(&out->text, &sub);
+			rope_push_string(&out->text, "; Conditional rep\n");
 		}
 
-		if (rep > r_end) {
-			rep = -1;
-		}
+		if (v.name != SYM_NONE)
+			var_end(&v);
+		if (cond)
+			break;
 	}
 
 	Variable free_to = {0};
 	
 	// Post control
-	if (scope_name_eq(&sub, "loop")) {
+	if (n->sub == CTRL_LOOP) {
 		if (build >= 0 && rep < 0) {
-			// find end of build, re-eval and cond jmp
-			int b_end = build;
-			t = vect_get(tokens, b_end);
-			while(!tok_str_eq(t, ")")) {
-				if (t->type == TT_DELIMIT) {
-					b_end = tnsl_find_closing(tokens, b_end);
-				}
-				b_end++;
-				t = vect_get(tokens, b_end);
-			}
+			// re-eval build and cond jmp
 			Variable v = _eval(&sub, out, tokens, build, b_end);
 			scope_free_all_tmp(&sub, out);
-			vect_push_string(&out->text, "\tjnz ");
-			vect_push_free_string(&out->text, scope_label_start(&sub));
-			vect_push_string(&out->text, "; Conditional rep\n");
+			rope_push_string(&out->text, "\tjnz ");
+			scope_label_start(&out->text, &sub);
+			rope_push_string(&out->text, "; Conditional rep\n");
 			var_end(&v);
 
 		} else if (build < 0 && rep < 0) {
-			vect_push_string(&out->text, "\tjmp ");
-			vect_push_free_string(&out->text, scope_label_start(&sub));
-			vect_push_string(&out->text, "\n");
+			rope_push_string(&out->text, "\tjmp ");
+			scope_label_start(&out->text, &sub);
+			rope_push_string(&out->text, "\n");
 		}
 	} else {
 		// Jmp to outer wrap at end of if
 		scope_free_to(&sub, out, &free_to);
-		vect_push_string(&out->text, "\tjmp ");
-		vect_push_free_string(&out->text, scope_label_end(s));
-		vect_push_string(&out->text, "\n");
+		rope_push_string(&out->text, "\tjmp ");
+		scope_label_end(&out->text, s);
+		rope_push_string(&out->text, "\n");
 	}
 	
 	// Cleanup scope
-	vect_push_free_string(&out->text, scope_label_end(&sub));
-	vect_push_string(&out->text, ": ; End label\n");
+	scope_label_end(&out->text, &sub);
+	rope_push_string(&out->text, ": ; End label\n");
 	scope_free_to(&sub, out, &free_to);
 	scope_end(&sub);
-	vect_push_string(&out->text, "\n\n");
+	rope_push_string(&out->text, "\n\n");
 }
 
 // Handles the 'self' variable in the case where the function is in a method block.
 void _p2_handle_method_scope(Module *root, CompData *out, Scope *fs, Function *f) {
 	
 	// load type for method
-	Artifact t_art = art_from_str((root->name + 2), '.');
+	Artifact t_art = art_from_str((sym_str(root->name) + 2), '.');
 	Type *t = mod_find_type(root, &t_art);
 	art_end(&t_art);
 	
 	// Create self var
-	Variable self = var_init("self", t);
+	Variable self = var_init(sym_intern("self"), t);
 	self.location = 1;
 	int pt = PTYPE_REF;
-	vect_push(&self.ptr_chain, &pt);
+	ptrc_push(&self.ptr_chain, pt);
 	
 	// Add to scope
 	Variable set = scope_mk_var(fs, out, &self);
@@ -5969,32 +7612,31 @@ void _p2_handle_method_scope(Module *root, CompData *out, Scope *fs, Function *f
 	var_end(&set);
 }
 
-void _p2_func_scope_init(Module *root, CompData *out, Scope *fs, Function *f, Vector *p_list) {
+void _p2_func_scope_init(Module *root, CompData *out, Scope *fs, Function *f, Artifact *p_list) {
 	// TODO: decide what happens when a function scope is created
 	
 	// export function if module is exported.
-	Vector tmp = _scope_base_label(fs);
 	if (root->exported) {
-		vect_push_string(&out->header, "global ");
-		vect_push_string(&out->header, vect_as_string(&tmp));
-		vect_push_string(&out->header, "\n");
+		rope_push_string(&out->header, "global ");
+		rope_push_string(&out->header, fs->label);
+		rope_push_string(&out->header, "\n");
 	}
 
 	// put the label
-	vect_push_free_string(&out->text, vect_as_string(&tmp));
-	vect_push_string(&out->text, ":\n");
+	rope_push_string(&out->text, fs->label);
+	rope_push_string(&out->text, ":\n");
 
 	// Update stack pointers
-	vect_push_string(&out->text, "\tpush rbp\n");
-	vect_push_string(&out->text, "\tlea rbp, [rsp + 8]\n");
+	rope_push_string(&out->text, "\tpush rbp\n");
+	rope_push_string(&out->text, "\tlea rbp, [rsp + 8]\n");
 	
 	// Push registers to save callee variables (subject to ABI change)
-	vect_push_string(&out->text, "\tpush r10\n");
-	vect_push_string(&out->text, "\tpush r11\n");
-	vect_push_string(&out->text, "\tpush r12\n");
-	vect_push_string(&out->text, "\tpush r13\n");
-	vect_push_string(&out->text, "\tpush r14\n");
-	vect_push_string(&out->text, "\tpush r15 ; scope init\n\n");
+	rope_push_string(&out->text, "\tpush r10\n");
+	rope_push_string(&out->text, "\tpush r11\n");
+	rope_push_string(&out->text, "\tpush r12\n");
+	rope_push_string(&out->text, "\tpush r13\n");
+	rope_push_string(&out->text, "\tpush r14\n");
+	rope_push_string(&out->text, "\tpush r15 ; scope init\n\n");
 
 	// Load function parameters into expected registers (we assume the stack frame was set up proprely by caller)
 	for (size_t i = 0; i < f->inputs.count; i++) {
@@ -6011,312 +7653,150 @@ void _p2_func_scope_init(Module *root, CompData *out, Scope *fs, Function *f, Ve
 }
 
 
-void p2_compile_function(Module *root, CompData *out, Vector *tokens, size_t *pos) {
-	int end = tnsl_find_closing(tokens, *pos);
-	Token *start = vect_get(tokens, *pos);
+void _p2_compile_function(Module *root, CompData *out, Vector *tokens, Node *n) {
+	Token *t;
 	
-	// Pre-checks for end of function and function name so scope can be initialized
-	if(end < 0) {
-		printf("ERROR: Could not find closing for function \"%s\" (%d:%d)\n\n", start->data, start->line, start->col);
-		p2_error = true;
-		return;
-	}
-
-	Vector p_list = tnsl_find_all_pointers(tokens, *pos, end);
-
-	Token *t = vect_get(tokens, *pos);
-	while (t != NULL && *pos < (size_t)end && t->type != TT_DEFWORD) {
-		t = vect_get(tokens, ++(*pos));
-		if(tok_str_eq(t, "\n"))
-			break;
-		else if (t->type == TT_DELIMIT && !tok_str_eq(t, ";/") && !tok_str_eq(t, ";;")) {
-			*pos = tnsl_find_closing(tokens, *pos);
-		}
-	}
-
-	if(t == NULL || t->type != TT_DEFWORD) {
-		printf("ERROR: Could not find user defined name for function \"%s\" (%d:%d)\n\n", start->data, start->line, start->col);
+	if (n->sub) {
+		t = vect_get(tokens, n->tok);
+		printf("ERROR: Could not find user defined name for function \"%.*s\" (%d:%d)\n\n", t->len, t->data, t->line, t->col);
 		p2_error = true;
 		return;
 	}
+	t = vect_get(tokens, n->start);
 
 	// fart
-	Artifact f_art = art_from_str(t->data, ' ');
+	Artifact f_art = art_from_str(sym_str(t->sym), ' ');
 	Function *f = mod_find_func(root, &f_art);
 	art_end(&f_art);
 
 	// Scope init
-	Scope fs = scope_init(t->data, root);
-	_p2_func_scope_init(root, out, &fs, f, &p_list);
-	if(root->name != NULL && strlen(root->name) > 1 && root->name[0] == '_' && root->name[1] == '#') {
+	Scope fs = scope_init(sym_str(t->sym), root);
+	_p2_func_scope_init(root, out, &fs, f, &n->ptrs);
+	if(mod_is_method(root)) {
 		_p2_handle_method_scope(root, out, &fs, f);
 	}
 
-	while(*pos < (size_t)end) {
-		t = vect_get(tokens, *pos);
-		if(tok_str_eq(t, "\n"))
-			break;
-		else if (t->type == TT_DELIMIT)
-			*pos = tnsl_find_closing(tokens, *pos);
-		*pos += 1;
-	}
-
-	*pos = tnsl_next_non_nl(tokens, *pos);
-	for (; *pos < (size_t)end; *pos = tnsl_next_non_nl(tokens, *pos)) {
-		t = vect_get(tokens, *pos);
-		if (tok_str_eq(t, "/;") || tok_str_eq(t, ";;")) {
-			size_t b_open = *pos;
-			
-			if(tnsl_block_type(tokens, *pos) == BT_CONTROL) {
-				p2_compile_control(&fs, f, out, tokens, pos, &p_list);
-			} else {
-				printf("ERROR: Only control blocks (if, else, loop, switch) are valid inside functions (%d:%d)\n\n", t->line, t->col);
-				p2_error = true;
-			}
-
-			if (*pos == b_open) {
-				*pos = tnsl_find_closing(tokens, b_open);
-			} else if (tok_str_eq(t, ";;")) {
-				*pos -= 1;
-			}
+	for (size_t i = 0; i < n->children.count; i++) {
+		Node *c = vect_get(&n->children, i);
+		t = vect_get(tokens, c->tok);
 
-		} else if (t->type == TT_KEYWORD) {
-			if(tok_str_eq(t, "return")) {
-				t = vect_get(tokens, *pos + 1);
-				if (f->outputs.count > 0) {
-					if (*pos + 1 < end && !tok_str_eq(t, "\n")) {
-						*pos += 1;
-						Variable *out_type = vect_get(&f->outputs, 0);
-						Variable e = eval(&fs, out, tokens, pos, true, out_type);
-						var_end(&e);
-					} else {
-						t = vect_get(tokens, *pos);
-						printf("ERROR: Attempt to return from a function without a value, but the function requires one (%d:%d)", t->line, t->col);
-						p2_error = true;
-					}
-				}
-				_p2_func_scope_end(out, &fs);
-				*pos = end;
-				scope_end(&fs);
-				return;
-			} else if (tok_str_eq(t, "asm")) {
-				t = vect_get(tokens, ++(*pos));
-				if(t->type != TT_LITERAL || t->data[0] != '"') {
-					printf("ERROR: Expected string literal after asm keyword (%d:%d)\n", t->line, t->col);
-					p2_error = true;
-				} else {
-					Vector asm_str = tnsl_unquote_str(t->data);
-					vect_push_string(&out->text, "\t");
-					vect_push_string(&out->text, vect_as_string(&asm_str));
-					vect_push_string(&out->text, "; User insert asm\n");
-					vect_end(&asm_str);
-				}
-			} else {
-				printf("ERROR: Keyword not implemented inside functions \"%s\" (%d:%d)\n", t->data, t->line, t->col);
-				p2_error = true;
-			}
-		} else if (tnsl_is_def(tokens, *pos)) {
-			p2_compile_def(&fs, out, tokens, pos, &p_list);
+		if (c->kind == AST_CONTROL || c->kind == AST_WRAP) {
+			p2_compile_control(&fs, f, out, tokens, c, &n->ptrs);
+		} else if (c->kind == AST_BLOCK) {
+			tnsl_block_report(tokens, c->sub, c->at);
+			printf("ERROR: Only control blocks (if, else, loop, switch) are valid inside functions (%d:%d)\n\n", t->line, t->col);
+			p2_error = true;
+		} else if (c->kind == AST_RETURN) {
+			_p2_compile_return(&fs, f, out, tokens, c);
+			scope_end(&fs);
+			return;
+		} else if (c->kind == AST_ASM) {
+			_p2_compile_asm(out, tokens, c);
+		} else if (c->kind == AST_KEYWORD) {
+			printf("ERROR: Keyword not implemented inside functions \"%.*s\" (%d:%d)\n", t->len, t->data, t->line, t->col);
+			p2_error = true;
+		} else if (c->kind == AST_DEF) {
+			p2_compile_def(&fs, out, tokens, c, &n->ptrs);
 		} else {
-			// TODO: figure out eval parameter needs (maybe needs start and end size_t?)
-			// and how eval will play into top level defs (if at all)
-			Variable e = eval(&fs, out, tokens, pos, false, NULL);
+			Variable e = eval(&fs, out, tokens, c->start, c->end, false, NULL);
 			var_end(&e);
 		}
 	}
 	
 	if (f->outputs.count > 0) {
+		t = vect_get(tokens, n->end);
 		printf("ERROR: Expected return value for function (%d:%d)\n\n", t->line, t->col);
 		p2_error = true;
 	}
 
 	_p2_func_scope_end(out, &fs);
 	scope_end(&fs);
-	art_end(&p_list);
-	*pos = end;
 }
 
-void p2_compile_method(Module *root, CompData *out, Vector *tokens, size_t *pos) {
-	int end = tnsl_find_closing(tokens, *pos);
-	Token *t = vect_get(tokens, *pos);
-	
-	if(end < 0) {
-		printf("ERROR: Could not find closing for method \"%s\" (%d:%d)\n\n", t->data, t->line, t->col);
-		p2_error = true;
-		return;
-	}
+// Compiles a function, then streams its finished text out and releases
+// everything it allocated in the scratch arena
+void p2_compile_function(Module *root, CompData *out, Vector *tokens, Node *n) {
+	_p2_compile_function(root, out, tokens, n);
+	cdat_flush(out);
+	arena_reset(&p2_scratch);
+}
 
-	*pos += 2;
-	t = vect_get(tokens, *pos);
+void p2_compile_method(Module *root, CompData *out, Vector *tokens, Node *n) {
+	Token *t = vect_get(tokens, n->start);
 
-	if (t == NULL || t->type != TT_DEFWORD) {
+	if (n->sub) {
 		printf("ERROR: Expected user defined type after 'method' keyword (%d:%d)\n\n", t->line, t->col);
-		*pos = end;
 		p2_error = true;
 		return;
 	}
 
 	Vector sub_name = vect_from_string("_#");
-	vect_push_string(&sub_name, t->data);
+	vect_push_nstring(&sub_name, t->data, t->len);
 
 	// TODO: method loop
-	Module *mmod = mod_find_sub(root, vect_as_string(&sub_name));
+	Module *mmod = mod_find_sub(root, sym_find(vect_as_string(&sub_name)));
 	vect_end(&sub_name);
 
-	for(;*pos < end;*pos = tnsl_next_non_nl(tokens, *pos)) {
-		t = vect_get(tokens, *pos);
-		if(tok_str_eq(t, "/;") != true && tok_str_eq(t, ";;") != true) {
-			continue;
-		}
-
-		p2_compile_function(mmod, out, tokens, pos);
-		
-		t = vect_get(tokens, *pos);
-		if(tok_str_eq(t, ";;")) {
-			*pos -= 1;
-		}
+	for (size_t i = 0; i < n->children.count; i++) {
+		p2_compile_function(mmod, out, tokens, vect_get(&n->children, i));
 	}
-	
-	*pos = end;
 }
 
-void p2_file_loop(
-		Artifact *path, Module *root, CompData *out,
-		Vector *tokens, size_t start, size_t end);
+void p2_file_loop(Module *root, CompData *out, Vector *tokens, Vector *items);
 
-void p2_compile_module(Artifact *path, Module *root, CompData *out, Vector *tokens, size_t *pos) {
-	int end = tnsl_find_closing(tokens, *pos);
-	Token *t = tnsl_find_last_token(tokens, *pos);
-
-	if (end < 0) {
-		printf("ERROR: Could not find closing delimiter for module (%d:%d)\n\n", t->line, t->col);
-		p2_error = true;
-		return;
-	}
-
-	*pos += 1;
-	t = vect_get(tokens, *pos);
-
-	if(tok_str_eq(t, "export")){
-		*pos += 1;
-	}
-
-	*pos += 1;
-	t = vect_get(tokens, *pos);
+void p2_compile_module(Module *root, CompData *out, Vector *tokens, Node *n) {
+	Token *t;
 
-	if (t == NULL || t->type != TT_DEFWORD) {
-		t = tnsl_find_last_token(tokens, *pos);
-		printf("ERROR: Expected module name after \"%s\" (%d:%d)\n\n", t->data, t->line, t->col);
+	if (n->sub) {
+		t = tnsl_find_last_token(tokens, n->start);
+		printf("ERROR: Expected module name after \"%.*s\" (%d:%d)\n\n", t->len, t->data, t->line, t->col);
 		p2_error = true;
-		*pos = end;
 		return;
 	}
 
-	Module *mod_root = mod_find_sub(root, t->data);
+	t = vect_get(tokens, n->start);
+	Module *mod_root = mod_find_sub(root, t->sym);
 
 	if(mod_root == NULL) {
-		printf("COMPILER ERROR: Could not find sub module for \"%s\" (%d:%d)\n\n", t->data, t->line, t->col);
+		printf("COMPILER ERROR: Could not find sub module for \"%.*s\" (%d:%d)\n\n", t->len, t->data, t->line, t->col);
 		p2_error = true;
-		*pos = end;
 		return;
 	}
 
-	p2_file_loop(path, mod_root, out, tokens, *pos, end);
-
-	*pos = end;
+	p2_file_loop(mod_root, out, tokens, &n->children);
 }
 
-CompData p2_compile_file(Artifact *path, Module *root) {
-	CompData out = cdat_init();
-
-	char *full_path = art_to_str(path, '/');
-	FILE *fin = fopen(full_path, "r");
-
-	if (fin == NULL) {
-		printf("Unable to open file %s for reading.\n\n", full_path);
-		p2_error = true;
-		free(full_path);
-		return out;
-	}
-
-	free(full_path);
-	
-	Vector tokens = parse_file(fin);
-	fclose(fin);
-
-	p2_file_loop(path, root, &out, &tokens, 0, tokens.count);
-
-	for (size_t i = 0; i < tokens.count; i++) {
-		Token *t = vect_get(&tokens, i);
-		free(t->data);
-	}
-
-	vect_end(&tokens);
-
+CompData p2_compile_file(SrcFile *file, Module *root, FILE *text_seg) {
+	CompData out = cdat_init_stream(text_seg);
+	p2_file_loop(root, &out, &file->tokens, &file->ast);
+	cdat_flush(&out);
 	return out;
 }
 
-void p2_file_loop(
-		Artifact *path, Module *root, CompData *out,
-		Vector *tokens, size_t start, size_t end) {
-	
-	for(;start < end; start++) {
-		Token *t = vect_get(tokens, start);
-		if (t->type == TT_SPLITTR && tok_str_eq(t, ":")) {
-			t = vect_get(tokens, ++start);
-			
-			if (t == NULL || !tok_str_eq(t, "import")) {
-				t = tnsl_find_last_token(tokens, start);
-				printf("ERROR: Comptime declarations are not implemented other than 'import' \"%s\" (%d:%d)\n\n", t->data, t->line, t->col);
-				p2_error = true;
-				continue;
-			}
-
-			t = vect_get(tokens, ++start);
-			if(t != NULL && t->type == TT_LITERAL) {
-				// Process new path to follow using old path.
-				char *cpy = art_to_str(path, '/');
-				Artifact new_path = art_from_str(cpy, '/');
-				free(cpy);
-
-				// Pop off file name
-				art_pop_str(&new_path);
-				
-				// Copy token data (something like "path/to/file.tnsl" including the quotes)
-				// This path is relative to the current file
-				Vector v = vect_from_string(t->data);
-				// Pop off last quote, replace with \0
-				vect_pop(&v);
-				vect_as_string(&v);
-				// Remove starting quote by indexing into data
-				Artifact addon = art_from_str((char *)v.data + 1, '/');
-				// No more need for copy string
-				vect_end(&v);
-				// Add relative path to current folder
-				art_add_art(&new_path, &addon);
-				// no more need for path relative to file
-				art_end(&addon);
+void p2_file_loop(Module *root, CompData *out, Vector *tokens, Vector *items) {
+	for (size_t i = 0; i < items->count; i++) {
+		Node *n = vect_get(items, i);
+		Token *t = tnsl_find_last_token(tokens, n->tok);
 
-				CompData dat = p2_compile_file(&new_path, root);
-				cdat_add(out, &dat);
-				cdat_end(&dat);
-				// Cleanup last remaining artifact
-				art_end(&new_path);
-			}
-		} else if (t->type == TT_DELIMIT && (tok_str_eq(t, "/;") || tok_str_eq(t, ";;"))) {
-			size_t block_start = start;
-			switch(tnsl_block_type(tokens, start)) {
-			case BT_FUNCTION:
-				p2_compile_function(root, out, tokens, &start);
-				break;
-			case BT_MODULE:
-				p2_compile_module(path, root, out, tokens, &start);
-				break;
-			case BT_METHOD:
-				p2_compile_method(root, out, tokens, &start);
-				break;
+		switch (n->kind) {
+		case AST_COMPTIME:
+			printf("ERROR: Comptime declarations are not implemented other than 'import' \"%.*s\" (%d:%d)\n\n", t->len, t->data, t->line, t->col);
+			p2_error = true;
+			break;
+		case AST_FUNCTION:
+			p2_compile_function(root, out, tokens, n);
+			break;
+		case AST_MODULE:
+			p2_compile_module(root, out, tokens, n);
+			break;
+		case AST_METHOD:
+			p2_compile_method(root, out, tokens, n);
+			break;
+		case AST_BLOCK:
+			tnsl_block_report(tokens, n->sub, n->at);
+			switch(n->sub) {
 			case BT_ENUM:
-				p2_compile_enum(root, out, tokens, &start);
+				p2_compile_enum(root, out, tokens, n);
 				break;
 			case BT_CONTROL:
 				printf("ERROR: Control blocks (if, loop, switch) can only be placed within a function block. (%d:%d)\n\n", t->line, t->col);
@@ -6324,67 +7804,113 @@ void p2_file_loop(
 				break;
 			case BT_INTERFACE:
 			case BT_OPERATOR:
-				printf("ERROR: Block type not implemented \"%s\" (%d:%d)\n\n", t->data, t->line, t->col);
+				printf("ERROR: Block type not implemented \"%.*s\" (%d:%d)\n\n", t->len, t->data, t->line, t->col);
 				p2_error = true;
 				break;
 			default:
-				printf("ERROR: Unknown block type \"%s\" at file root (%d:%d)\n\n", t->data, t->line, t->col);
+				printf("ERROR: Unknown block type \"%.*s\" at file root (%d:%d)\n\n", t->len, t->data, t->line, t->col);
 				p2_error = true;
 				break;
 			}
-			
-			t = vect_get(tokens, start);
+			break;
+		case AST_ASM:
+			rope_push_string(&out->header, t->str);
+			rope_push_string(&out->header, "\n");
+			break;
+		case AST_FDEF:
+			p2_compile_fdef(root, out, tokens, n);
+			break;
+		}
+	}
+}
 
-			if (start == block_start) {
-				int chk = tnsl_find_closing(tokens, start);
-				if (chk < 0)
-					printf("ERROR: Could not find closing for \"%s\" (%d:%d)\n\n", t->data, t->line, t->col);
-				else
-					start = chk;
-			} else if (tok_str_eq(t, ";;")) {
-				start--;
-			}
-		} else if (tok_str_eq(t, "asm")) {
-			// TODO: top level asm should go where?
-			start++;
-			t = vect_get(tokens, start);
-			if(t != NULL && t->type == TT_LITERAL) {
-				Vector asm_str = tnsl_unquote_str(t->data);
-				if (asm_str.count > 0) {
-					vect_push_string(&out->header, vect_as_string(&asm_str));
-					vect_push_string(&out->header, "\n");
-				}
-				vect_end(&asm_str);
-			}
-		} else if (tok_str_eq(t, "struct")){
-			start += 2;
-			start = tnsl_find_closing(tokens, start);
-		} else if (tnsl_is_def(tokens, start)) {
-			p2_compile_fdef(root, out, tokens, &start);
+// Finds the module with the given full path (as generated by mod_full_path)
+Module *_p2_find_module(Module *root, char *path) {
+	Artifact mod_path = art_from_str(path, '.');
+
+	for (size_t i = 0; i < mod_path.segs.count && root != NULL; i++) {
+		root = mod_find_sub(root, art_get(&mod_path, i));
+	}
+
+	art_end(&mod_path);
+	return root;
+}
+
+// Compiles every file in the import graph exactly once, in topological
+// order so imported code comes before the code which imports it.
+// Function text is streamed to a temporary segment when one can be made,
+// so only the header and data sections are held in memory.
+CompData phase_2(Vector *cache, Module *root) {
+	CompData out = cdat_init_stream(tmpfile());
+
+	if (cache->count < 1) {
+		p2_error = true;
+		return out;
+	}
+
+	// The first file cached is the one being compiled
+	SrcFile **first = vect_get(cache, 0);
+	Vector order = src_compile_order(*first);
+
+	for (size_t i = 0; i < order.count; i++) {
+		SrcFile **file = vect_get(&order, i);
+		Module *mod = _p2_find_module(root, (*file)->module);
+
+		if (mod == NULL) {
+			printf("COMPILER ERROR: Could not find module \"%s\" for file %s\n\n", (*file)->module, (*file)->path);
+			p2_error = true;
+			continue;
 		}
+
+		CompData dat = p2_compile_file(*file, mod, out.text_seg);
+		cdat_add(&out, &dat);
+		cdat_end(&dat);
 	}
+
+	vect_end(&order);
+	return out;
 }
 
+// Frees the output of phase 2 along with its text segment
+void compile_end(CompData *out) {
+	if (out->text_seg != NULL)
+		fclose(out->text_seg);
+	cdat_end(out);
+}
 
 void compile(Artifact *path_in, Artifact *path_out) {
 
 	// Root module used for artifact resolution
-	Module root = mod_init("", NULL, true);
+	Module root = mod_init(sym_intern(""), NULL, true);
 
-	phase_1(path_in, &root);
+	// Tokenized source files, shared by both phases
+	Vector cache = vect_init(sizeof(SrcFile *));
+
+	var_arena = &mod_arena;
+	phase_1(&cache, path_in, &root);
 	
 	if (p1_error) {
 		printf("Parser encountered errors, stopping.\n\n");
-		mod_deep_end(&root);
+		arena_end(&mod_arena);
+		var_arena = NULL;
+		src_cache_end(&cache);
 		return;
 	}
 
-	CompData out = p2_compile_file(path_in, &root);
-	mod_deep_end(&root);
+	var_arena = &p2_scratch;
+	mod_memo = vect_init_in(&mod_arena, sizeof(void *));
+	mod_memo_on = true;
+	CompData out = phase_2(&cache, &root);
+	mod_memo_on = false;
+	vect_end(&mod_memo);
+	arena_end(&mod_arena);
+	arena_end(&p2_scratch);
+	var_arena = NULL;
+	src_cache_end(&cache);
 
 	if (p2_error) {
 		printf("Compiler encountered errors, stopping.\n\n");
-		cdat_end(&out);
+		compile_end(&out);
 		return;
 	}
 
@@ -6393,17 +7919,15 @@ void compile(Artifact *path_in, Artifact *path_out) {
 	
 	if (fout == NULL) {
 		printf("Unable to open output file %s for writing.\n\n", full_path);
-		free(full_path);
-		cdat_end(&out);
+		compile_end(&out);
 		return;
 	}
-	
-	free(full_path);
-
-	cdat_write_to_file(&out, fout);
 
+	if (!cdat_write_to_file(&out, fout))
+		printf("Unable to write output file %s.\n\n", full_path);
+	
 	fclose(fout);
-	cdat_end(&out);
+	compile_end(&out);
 }
 
 char *tok_type_strs[] = {
@@ -6417,45 +7941,56 @@ char *tok_type_strs[] = {
 };
 
 void write_token(FILE *out, Token *t) {
-	fprintf(out, "{line: %d, column: %d, type %s, data: \"%s\"}\n", t->line, t->col, tok_type_strs[t->type], t->data);
+	fprintf(out, "{line: %d, column: %d, type %s, data: \"%.*s\"}\n", t->line, t->col, tok_type_strs[t->type], t->len, t->data);
 }
 
-void tokenize(Artifact *path_in, Artifact *path_out) {
-	char *full_path = art_to_str(path_in, '/');
-	FILE *fin = fopen(full_path, "r");
+// Writes the tokens of a file (source or binary token stream) either as a
+// binary token stream or as readable text
+void tokenize(Artifact *path_in, Artifact *path_out, bool text) {
+	char *in_path = art_to_str(path_in, '/');
+	FILE *fin = fopen(in_path, "r");
 
 	if (fin == NULL) {
-		printf("Unable to open file %s for reading.\n\n", full_path);
-		free(full_path);
+		printf("Unable to open file %s for reading.\n\n", in_path);
 		return;
 	}
 
-	free(full_path);
-	full_path = art_to_str(path_out, '/');
+	char *full_path = art_to_str(path_out, '/');
 	FILE *fout = fopen(full_path, "w");
 	
 	if (fout == NULL) {
 		printf("Unable to open file %s for writing.\n\n", full_path);
-		free(full_path);
 		fclose(fin);
 		return;
 	}
 
-	free(full_path);
 	
-	Vector tokens = parse_file(fin);
+	size_t len;
+	char *src = read_file(fin, &len);
 	fclose(fin);
 
-	for(size_t i = 0; i < tokens.count; i++) {
-		Token *t = vect_get(&tokens, i);
-		write_token(fout, t);
-		free(t->data);
+	Vector tokens;
+	if (!tok_load(src, len, &tokens)) {
+		printf("Malformed token stream in file %s.\n\n", in_path);
+		fclose(fout);
+		free(src);
+		return;
+	}
+
+	if (text) {
+		for(size_t i = 0; i < tokens.count; i++) {
+			Token *t = vect_get(&tokens, i);
+			write_token(fout, t);
+		}
+	} else {
+		tok_write_binary(fout, &tokens);
 	}
 
 	fflush(fout);
 	fclose(fout);
 
-	vect_end(&tokens);
+	tok_stream_end(&tokens);
+	free(src);
 }
 
 // Entrypoint
@@ -6468,8 +8003,11 @@ void help() {
 	printf("\tctc [file in] [file out]       - same as before, but write the output assembly to the given filename\n");
 	printf("\t    -h                         - print this output message\n");
 	printf("\t    -v                         - print version information\n");
-	printf("\t    -t [file in]               - output tokenization of file instead of assembly in out.asm\n");
-	printf("\t    -t [file in] [file out]    - output tokenization of file instead of assembly in output file\n");
+	printf("\t    -t [file in]               - output binary tokenization of file instead of assembly in out.asm\n");
+	printf("\t    -t [file in] [file out]    - output binary tokenization of file instead of assembly in output file\n");
+	printf("\t    -T [file in] [file out]    - same as -t, but output the tokenization as readable text\n");
+	printf("\n");
+	printf("\tBinary tokenizations (from -t) can be given in place of any source file.\n");
 	printf("\n");
 }
 
@@ -6480,7 +8018,7 @@ int main(int argc, char ** argv) {
 	} else if (strcmp(argv[1], "-v") == 0) {
 		printf("C based TNSL Compiler (CTC) - version 0.4.1\n");
 		return 0;
-	} else if (strcmp(argv[1], "-t") == 0) {
+	} else if (strcmp(argv[1], "-t") == 0 || strcmp(argv[1], "-T") == 0) {
 		Artifact in = art_from_str(argv[2], '/');
 		Artifact out;
 		if (argc == 3) {
@@ -6488,9 +8026,10 @@ int main(int argc, char ** argv) {
 		} else {
 			out = art_from_str(argv[3], '/');
 		}
-		tokenize(&in, &out);
+		tokenize(&in, &out, argv[1][1] == 'T');
 		art_end(&in);
 		art_end(&out);
+		sym_end();
 		return 0;
 	}
 
@@ -6505,6 +8044,7 @@ int main(int argc, char ** argv) {
 	compile(&in, &out);
 	art_end(&in);
 	art_end(&out);
+	sym_end();
 
 	return 0;
 }